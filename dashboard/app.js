@@ -42,6 +42,8 @@ class DashboardApp {
         this.tokenExpiry = null;
         this.username = null;
         this.pendingRequests = new Map();
+        this.notificationEpoch = null;
+        this.lastSeq = null;
         this.reconnectTimer = null;
         this.tokenRefreshTimer = null;
         this.refreshInFlight = false;
@@ -217,6 +219,7 @@ class DashboardApp {
                 'login.invalidResponse': 'Invalid response from server.',
                 'login.invalidRequest': 'The login request was malformed. Please reload the page and try again.',
                 'login.unauthorized': 'The provided credentials were not accepted.',
+                'login.tooManyRequests': 'Too many login attempts. Please wait a moment and try again.',
 
                 'connection.connecting': 'Connecting…',
                 'connection.authenticating': 'Authenticating…',
@@ -366,6 +369,7 @@ class DashboardApp {
                 'login.invalidResponse': 'Ungültige Serverantwort.',
                 'login.invalidRequest': 'Die Login-Anfrage war fehlerhaft. Bitte Seite neu laden und erneut versuchen.',
                 'login.unauthorized': 'Die eingegebenen Zugangsdaten wurden nicht akzeptiert.',
+                'login.tooManyRequests': 'Zu viele Anmeldeversuche. Bitte kurz warten und erneut versuchen.',
 
                 'connection.connecting': 'Verbinden…',
                 'connection.authenticating': 'Authentifizierung…',
@@ -773,6 +777,8 @@ class DashboardApp {
             return this.t('login.invalidRequest');
         case 'unauthorized':
             return this.t('login.unauthorized');
+        case 'tooManyRequests':
+            return this.t('login.tooManyRequests');
         default:
             return this.t('login.failed');
         }
@@ -801,6 +807,8 @@ class DashboardApp {
         this.tokenExpiry = null;
         this.username = null;
         this.pendingRequests.clear();
+        this.notificationEpoch = null;
+        this.lastSeq = null;
         clearTimeout(this.reconnectTimer);
         this.reconnectTimer = null;
         clearTimeout(this.tokenRefreshTimer);
@@ -870,9 +878,14 @@ class DashboardApp {
         if (!this.socket || this.socket.readyState !== WebSocket.OPEN)
             return;
 
-        this.sendAction('authenticate', {
-            token: this.token
-        });
+        const payload = { token: this.token };
+
+        // After a reconnect only the notifications missed in between are fetched. The server
+        // replays them before the client receives live notifications again.
+        if (this.notificationEpoch && this.lastSeq !== null)
+            payload.resume = { epoch: this.notificationEpoch, lastSeq: this.lastSeq };
+
+        this.sendAction('authenticate', payload);
     }
 
     onSocketMessage(event) {
@@ -911,12 +924,39 @@ class DashboardApp {
 
         if (type === 'authenticate') {
             if (data.success)
-                this.onAuthenticationSucceeded();
+                this.onAuthenticationSucceeded(data.payload || {});
             else
                 this.onAuthenticationFailed(data.error || 'unauthorized');
             return true;
         }
 
+        if (type === 'batch') {
+            const payload = data && data.payload ? data.payload : {};
+            const responses = data.success && Array.isArray(payload.responses) ? payload.responses : [];
+            responses.forEach(response => {
+                if (!response || !response.requestId || !this.pendingRequests.has(response.requestId))
+                    return;
+
+                const subPending = this.pendingRequests.get(response.requestId);
+                this.pendingRequests.delete(response.requestId);
+                this.handlePendingResponse(subPending, response);
+            });
+
+            // Sub requests without an answer are sent one by one
+            (pending.requestIds || []).forEach(requestId => {
+                const subPending = this.pendingRequests.get(requestId);
+                if (!subPending)
+                    return;
+
+                this.pendingRequests.delete(requestId);
+                this.sendAction(subPending.action, subPending.payload);
+            });
+
+            if (!data.success && data.error === 'unauthenticated')
+                this.onAuthenticationFailed('unauthenticated');
+            return true;
+        }
+
         if (type === 'getchargers') {
             if (data.success) {
                 const payload = data && data.payload ? data.payload : {};
@@ -930,6 +970,19 @@ class DashboardApp {
             return true;
         }
 
+        if (type === 'getsnapshot') {
+            if (data.success) {
+                const payload = data && data.payload ? data.payload : {};
+                this.processCarList(Array.isArray(payload.cars) ? payload.cars : []);
+                this.processChargerList(Array.isArray(payload.chargers) ? payload.chargers : []);
+            } else if (data.error === 'unauthenticated') {
+                this.onAuthenticationFailed('unauthenticated');
+            } else {
+                console.warn('GetSnapshot request failed', data.error || 'unknownError');
+            }
+            return true;
+        }
+
         if (type === 'getcars') {
             if (data.success) {
                 const payload = data && data.payload ? data.payload : {};
@@ -964,8 +1017,14 @@ class DashboardApp {
         if (!data)
             return false;
 
-        if (data.event && this.handleNotificationEvent(data.event, data.payload))
-            return true;
+        if (data.event) {
+            // Replayed frames always arrive before live ones, the sequence only grows
+            if (typeof data.seq === 'number' && (this.lastSeq === null || data.seq > this.lastSeq))
+                this.lastSeq = data.seq;
+
+            if (this.handleNotificationEvent(data.event, data.payload))
+                return true;
+        }
 
         if (!data.payload)
             return false;
@@ -1024,19 +1083,53 @@ class DashboardApp {
             if (payload && Array.isArray(payload.sessions))
                 this.renderChargingSessions(payload.sessions);
             return true;
+        case 'groupchanged':
+        case 'groupremoved':
+            // Group aggregates are meant for overview screens, the dashboard shows every charger
+            return true;
         default:
             return false;
         }
     }
 
-    onAuthenticationSucceeded() {
+    onAuthenticationSucceeded(payload = {}) {
         this.updateConnectionStatus(this.t('connection.connected'), 'connected');
         this.updateSessionUser();
-        this.sendGetCars();
-        this.sendGetChargers();
+
+        if (typeof payload.resumed === 'boolean') {
+            this.onResumeFinished(payload);
+            return;
+        }
+
+        this.notificationEpoch = payload.epoch || null;
+        this.lastSeq = typeof payload.seq === 'number' ? payload.seq : null;
+        this.reloadState();
+    }
+
+    onResumeFinished(payload) {
+        this.notificationEpoch = payload.epoch || null;
+        if (payload.resumed) {
+            console.log(`Resumed WebSocket session, ${payload.replayed || 0} notifications replayed`);
+            return;
+        }
+
+        // The gap was not covered by the replay log, start over from the snapshot
+        this.lastSeq = typeof payload.seq === 'number' ? payload.seq : null;
+        if (Array.isArray(payload.cars))
+            this.processCarList(payload.cars);
+        if (Array.isArray(payload.chargers))
+            this.processChargerList(payload.chargers);
         this.fetchChargingSessions();
     }
 
+    reloadState() {
+        // One round trip for the initial state
+        this.sendBatch([
+            { action: 'GetSnapshot', payload: { } },
+            { action: 'GetChargingSessions', payload: this.chargingSessionsPayload() }
+        ]);
+    }
+
     onAuthenticationFailed(reason) {
         const message = reason === 'unauthenticated'
             ? this.t('connection.sessionExpired')
@@ -1090,6 +1183,25 @@ class DashboardApp {
         return requestId;
     }
 
+    sendBatch(requests) {
+        if (!this.socket || this.socket.readyState !== WebSocket.OPEN) {
+            console.warn('Cannot send batch. WebSocket not connected.');
+            return null;
+        }
+
+        const subRequests = requests.map(request => {
+            const requestId = this.generateRequestId();
+            const normalizedAction = typeof request.action === 'string' ? request.action.toLowerCase() : '';
+            this.pendingRequests.set(requestId, { type: normalizedAction, action: request.action, payload: request.payload });
+            return { requestId, action: request.action, payload: request.payload };
+        });
+
+        const requestId = this.generateRequestId();
+        this.pendingRequests.set(requestId, { type: 'batch', requestIds: subRequests.map(request => request.requestId) });
+        this.socket.send(JSON.stringify({ requestId, action: 'Batch', payload: { requests: subRequests } }));
+        return requestId;
+    }
+
     isAuthenticated() {
         for (const pending of this.pendingRequests.values()) {
             if (pending.type === 'authenticate')
@@ -1110,13 +1222,17 @@ class DashboardApp {
         return this.sendAction('GetChargers', { });
     }
 
-    fetchChargingSessions() {
+    chargingSessionsPayload() {
         const payload = {};
         const carId = this.elements.carFilter ? this.elements.carFilter.value : '';
         if (carId)
             payload.carId = carId;
 
-        const requestId = this.sendAction('GetChargingSessions', payload);
+        return payload;
+    }
+
+    fetchChargingSessions() {
+        const requestId = this.sendAction('GetChargingSessions', this.chargingSessionsPayload());
         if (!requestId)
             this.renderChargingSessions([], this.t('sessions.requestFailed'));
 
@@ -2414,6 +2530,17 @@ class DashboardApp {
                 body: JSON.stringify({ token: this.token })
             });
 
+            if (response.status === 429) {
+                // Throttled by the server, keep the session and try again later
+                const retryAfter = Number.parseInt(response.headers.get('Retry-After'), 10);
+                const delay = (Number.isFinite(retryAfter) ? retryAfter : 5) * 1000;
+                clearTimeout(this.tokenRefreshTimer);
+                this.tokenRefreshTimer = setTimeout(() => {
+                    this.refreshToken();
+                }, delay);
+                return;
+            }
+
             const data = await response.json();
             if (!response.ok || !data.success)
                 throw new Error(data && data.error ? data.error : 'refreshFailed');
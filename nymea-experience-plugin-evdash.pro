@@ -1,3 +1,7 @@
 TEMPLATE = subdirs
-SUBDIRS += plugin
+SUBDIRS += plugin tests tools
 
+# make benchmark: run all benchmarks and write the QtTest XML results
+benchmark.CONFIG = recursive
+benchmark.recurse = tests
+QMAKE_EXTRA_TARGETS += benchmark
@@ -33,15 +33,18 @@
 #include <QDBusPendingReply>
 #include <QDBusReply>
 #include <QDBusServiceWatcher>
+#include <QTimer>
 
 static const QString kDbusService = QStringLiteral("io.nymea.energy.chargingsessions");
 static const QString kDbusPath = QStringLiteral("/io/nymea/energy/chargingsessions");
 static const QString kDbusInterface = QStringLiteral("io.nymea.energy.chargingsessions");
 
-ChargingSessionsDBusInterfaceClient::ChargingSessionsDBusInterfaceClient(QObject *parent)
+ChargingSessionsDBusInterfaceClient::ChargingSessionsDBusInterfaceClient(const QDBusConnection &connection, QObject *parent)
     : QObject(parent)
-    , m_connection(QDBusConnection::systemBus())
+    , m_connection(connection)
 {
+    m_callClock.start();
+
     m_serviceWatcher = new QDBusServiceWatcher(kDbusService, m_connection, QDBusServiceWatcher::WatchForRegistration | QDBusServiceWatcher::WatchForUnregistration, this);
     connect(m_serviceWatcher, &QDBusServiceWatcher::serviceRegistered, this, &ChargingSessionsDBusInterfaceClient::onServiceRegistered);
     connect(m_serviceWatcher, &QDBusServiceWatcher::serviceUnregistered, this, &ChargingSessionsDBusInterfaceClient::onServiceUnregistered);
@@ -57,20 +60,19 @@ ChargingSessionsDBusInterfaceClient::~ChargingSessionsDBusInterfaceClient()
     delete m_interface;
 }
 
-QList<QVariantMap> ChargingSessionsDBusInterfaceClient::sessions() const
-{
-    return m_sessions;
-}
-
 void ChargingSessionsDBusInterfaceClient::getSessions(const QStringList &carThingIds, qlonglong startTimestamp, qlonglong endTimestamp)
 {
+    // Reported like a failed call, never from within getSessions(). Callers register
+    // their pending request only after the call returned.
     if (!ensureInterface()) {
-        emit errorOccurred(QStringLiteral("Charging sessions DBus interface is not available"));
+        QTimer::singleShot(0, this, [this]() { emit errorOccurred(QStringLiteral("Charging sessions DBus interface is not available")); });
         return;
     }
 
     QDBusPendingCall call = m_interface->asyncCall(QStringLiteral("GetSessions"), carThingIds, startTimestamp, endTimestamp);
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
+    watcher->setProperty("startTime", m_callClock.nsecsElapsed());
+    watcher->setProperty("carThingIds", carThingIds);
     connect(watcher, &QDBusPendingCallWatcher::finished, this, &ChargingSessionsDBusInterfaceClient::onCallFinished);
 }
 
@@ -79,6 +81,8 @@ void ChargingSessionsDBusInterfaceClient::onCallFinished(QDBusPendingCallWatcher
     QDBusPendingReply<QVariantList> reply = *watcher;
     watcher->deleteLater();
 
+    emit callFinished(QStringLiteral("GetSessions"), m_callClock.nsecsElapsed() - watcher->property("startTime").toLongLong(), !reply.isError());
+
     if (reply.isError()) {
         emit errorOccurred(reply.error().message());
         return;
@@ -96,8 +100,8 @@ void ChargingSessionsDBusInterfaceClient::onCallFinished(QDBusPendingCallWatcher
         sessions.append(qdbus_cast<QVariantMap>(arg));
     }
 
-    m_sessions = sessions;
-    emit sessionsReceived(m_sessions);
+    // Not kept here, the engine indexes the sessions in its session store
+    emit sessionsReceived(sessions, watcher->property("carThingIds").toStringList());
 }
 
 bool ChargingSessionsDBusInterfaceClient::ensureInterface()
@@ -26,6 +26,7 @@
 
 #include <QDBusConnection>
 #include <QDBusServiceWatcher>
+#include <QElapsedTimer>
 #include <QList>
 #include <QObject>
 #include <QStringList>
@@ -39,17 +40,17 @@ class ChargingSessionsDBusInterfaceClient : public QObject
 {
     Q_OBJECT
 public:
-    explicit ChargingSessionsDBusInterfaceClient(QObject *parent = nullptr);
+    explicit ChargingSessionsDBusInterfaceClient(const QDBusConnection &connection, QObject *parent = nullptr);
     ~ChargingSessionsDBusInterfaceClient();
 
-    QList<QVariantMap> sessions() const;
-
 public slots:
     void getSessions(const QStringList &carThingIds = QStringList(), qlonglong startTimestamp = 0, qlonglong endTimestamp = 0);
 
 signals:
-    void sessionsReceived(const QList<QVariantMap> &sessions);
+    // The car filter of the call the sessions answer, empty for all cars
+    void sessionsReceived(const QList<QVariantMap> &sessions, const QStringList &carThingIds);
     void errorOccurred(const QString &message);
+    void callFinished(const QString &method, qint64 durationNanoseconds, bool success);
 
 private slots:
     void onCallFinished(QDBusPendingCallWatcher *watcher);
@@ -62,5 +63,5 @@ private:
     QDBusConnection m_connection;
     QDBusInterface *m_interface = nullptr;
     QDBusServiceWatcher *m_serviceWatcher = nullptr;
-    QList<QVariantMap> m_sessions;
+    QElapsedTimer m_callClock;
 };
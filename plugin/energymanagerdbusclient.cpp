@@ -27,6 +27,7 @@
 #include <QDBusArgument>
 #include <QDBusConnection>
 #include <QDBusConnectionInterface>
+#include <QDBusError>
 #include <QDBusInterface>
 #include <QDBusMessage>
 #include <QDBusMetaType>
@@ -34,17 +35,18 @@
 #include <QDBusPendingCallWatcher>
 #include <QDBusReply>
 #include <QDBusServiceWatcher>
+#include <QElapsedTimer>
 
 static const QString kDbusService = QStringLiteral("io.nymea.energymanager");
 static const QString kDbusPath = QStringLiteral("/io/nymea/energymanager");
 static const QString kDbusInterface = QStringLiteral("io.nymea.energymanager");
 
-EnergyManagerDbusClient::EnergyManagerDbusClient(QObject *parent)
+EnergyManagerDbusClient::EnergyManagerDbusClient(const QDBusConnection &connection, QObject *parent)
     : QObject(parent)
-    , m_connection(QDBusConnection::systemBus())
+    , m_connection(connection)
 {
     if (!m_connection.isConnected()) {
-        emit errorOccurred(QStringLiteral("DBus system bus not connected"));
+        emit errorOccurred(QStringLiteral("DBus connection not available: %1").arg(m_connection.lastError().message()));
         return;
     }
 
@@ -65,6 +67,11 @@ QVariantList EnergyManagerDbusClient::chargingInfos() const
     return m_chargingInfos;
 }
 
+bool EnergyManagerDbusClient::chargingInfosReceived() const
+{
+    return m_chargingInfosReceived;
+}
+
 void EnergyManagerDbusClient::refreshChargingInfos()
 {
     if (!m_interface || !m_interface->isValid()) {
@@ -79,7 +86,10 @@ void EnergyManagerDbusClient::refreshChargingInfos()
         return;
     }
 
+    QElapsedTimer callTimer;
+    callTimer.start();
     QDBusReply<QVariantList> reply = m_interface->call(QStringLiteral("chargingInfos"));
+    emit callFinished(QStringLiteral("chargingInfos"), callTimer.nsecsElapsed(), reply.isValid());
     if (!reply.isValid()) {
         emit errorOccurred(reply.error().message());
         return;
@@ -98,6 +108,7 @@ void EnergyManagerDbusClient::refreshChargingInfos()
     }
 
     m_chargingInfos = convertedInfos;
+    m_chargingInfosReceived = true;
     emit chargingInfosUpdated(m_chargingInfos);
 }
 
@@ -37,10 +37,12 @@ class EnergyManagerDbusClient : public QObject
 {
     Q_OBJECT
 public:
-    explicit EnergyManagerDbusClient(QObject *parent = nullptr);
+    explicit EnergyManagerDbusClient(const QDBusConnection &connection, QObject *parent = nullptr);
     ~EnergyManagerDbusClient();
 
     QVariantList chargingInfos() const;
+    // False until the energy manager has reported its charging infos once
+    bool chargingInfosReceived() const;
 
 public slots:
     void refreshChargingInfos();
@@ -51,6 +53,7 @@ signals:
     void chargingInfoRemoved(const QString &evChargerId);
     void chargingInfoChanged(const QVariantMap &chargingInfo);
     void errorOccurred(const QString &message);
+    void callFinished(const QString &method, qint64 durationNanoseconds, bool success);
 
 private slots:
     void onChargingInfoAdded(const QVariantMap &chargingInfo);
@@ -68,6 +71,7 @@ private:
     QDBusInterface *m_interface = nullptr;
     QDBusServiceWatcher *m_serviceWatcher = nullptr;
     QVariantList m_chargingInfos;
+    bool m_chargingInfosReceived = false;
 };
 
 #endif // ENERGYMANAGERDBUSCLIENT_H
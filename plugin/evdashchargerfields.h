@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef EVDASHCHARGERFIELDS_H
+#define EVDASHCHARGERFIELDS_H
+
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QLatin1String>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+// Schema of the packed charger. Plain charger states are listed in one
+// table, which drives packing, change detection and the field masks of the
+// Subscribe action. A new state field only needs a line in s_stateFields.
+// Chargers are packed into Values indexed by mask bit, diffing and projection
+// work on those, the keys only come in when the JSON object is built.
+namespace EvDashChargerFields {
+
+typedef QJsonValue (*JsonConverter)(const QVariant &value);
+
+template<typename T>
+QJsonValue jsonValue(const QVariant &value)
+{
+    return QJsonValue(value.value<T>());
+}
+
+struct StateField
+{
+    const char *stateName;
+    const char *key;
+    JsonConverter toJson;
+    // Optional states are only packed if the thing class has them
+    bool optional;
+};
+
+constexpr StateField s_stateFields[] = {
+    {"connected", "connected", &jsonValue<bool>, false},
+    {"maxChargingCurrent", "chargingCurrent", &jsonValue<double>, false},
+    {"currentPower", "currentPower", &jsonValue<double>, false},
+    {"pluggedIn", "pluggedIn", &jsonValue<bool>, false},
+    {"power", "chargingAllowed", &jsonValue<bool>, false},
+    {"currentVersion", "version", &jsonValue<double>, true},
+    {"sessionEnergy", "sessionEnergy", &jsonValue<double>, true},
+    {"desiredPhaseCount", "chargingPhases", &jsonValue<int>, true},
+    // PCE specific
+    {"temperature", "temperature", &jsonValue<double>, true},
+    {"error", "error", &jsonValue<QString>, true},
+    {"status", "status", &jsonValue<QString>, true},
+    {"digitalInputMode", "digitalInputMode", &jsonValue<int>, true},
+};
+
+constexpr int s_stateFieldCount = sizeof(s_stateFields) / sizeof(s_stateFields[0]);
+
+// Fields the engine derives from other sources, they come first in the masks
+enum DerivedField { FieldId, FieldName, FieldAssignedCar, FieldEnergyManagerMode, FieldLastStatusUpdate, FieldStale, DerivedFieldCount };
+
+constexpr const char *s_derivedFieldKeys[] = {"id", "name", "assignedCar", "energyManagerMode", "lastStatusUpdate", "stale"};
+
+static_assert(sizeof(s_derivedFieldKeys) / sizeof(s_derivedFieldKeys[0]) == DerivedFieldCount, "Every derived field needs a key");
+
+constexpr int s_fieldCount = DerivedFieldCount + s_stateFieldCount;
+
+static_assert(s_fieldCount <= 32, "Field masks are 32 bit wide");
+
+constexpr quint32 derivedFieldBit(DerivedField field)
+{
+    return 1u << field;
+}
+
+constexpr quint32 stateFieldBit(int index)
+{
+    return 1u << (DerivedFieldCount + index);
+}
+
+constexpr quint32 s_allFields = s_fieldCount == 32 ? 0xffffffffu : (1u << s_fieldCount) - 1;
+
+constexpr const char *fieldKey(int bit)
+{
+    return bit < DerivedFieldCount ? s_derivedFieldKeys[bit] : s_stateFields[bit - DerivedFieldCount].key;
+}
+
+constexpr bool equalKeys(const char *a, const char *b)
+{
+    return *a == *b && (*a == '\0' || equalKeys(a + 1, b + 1));
+}
+
+constexpr bool keyDiffersFrom(int bit, int other)
+{
+    return other >= s_fieldCount || (!equalKeys(fieldKey(bit), fieldKey(other)) && keyDiffersFrom(bit, other + 1));
+}
+
+constexpr bool keysUnique(int bit = 0)
+{
+    return bit >= s_fieldCount || (keyDiffersFrom(bit, bit + 1) && keysUnique(bit + 1));
+}
+
+static_assert(keysUnique(), "Field keys have to be unique");
+
+// Packed charger, one value per mask bit. Undefined values are left out of the JSON object.
+typedef QVector<QJsonValue> Values;
+
+// The keys as QString, converted once
+inline const QVector<QString> &fieldNames()
+{
+    static const QVector<QString> names = []() {
+        QVector<QString> names;
+        for (int bit = 0; bit < s_fieldCount; bit++)
+            names.append(QString::fromLatin1(fieldKey(bit)));
+        return names;
+    }();
+    return names;
+}
+
+// Mask bit of a key, -1 if unknown
+inline int fieldBit(const QString &key)
+{
+    return fieldNames().indexOf(key);
+}
+
+// Bits of the fields which differ between two packed chargers
+inline quint32 changedFields(const Values &previous, const Values &current)
+{
+    quint32 changed = 0;
+    for (int bit = 0; bit < s_fieldCount; bit++) {
+        if (previous.at(bit) != current.at(bit))
+            changed |= 1u << bit;
+    }
+
+    return changed;
+}
+
+// The charger as JSON object, reduced to the fields of the mask
+inline QJsonObject toJson(const Values &values, quint32 mask = s_allFields)
+{
+    const QVector<QString> &names = fieldNames();
+    QJsonObject charger;
+    for (int bit = 0; bit < s_fieldCount; bit++) {
+        if ((mask & (1u << bit)) && !values.at(bit).isUndefined())
+            charger.insert(names.at(bit), values.at(bit));
+    }
+
+    return charger;
+}
+
+} // namespace EvDashChargerFields
+
+#endif // EVDASHCHARGERFIELDS_H
@@ -25,33 +25,231 @@
 #include "evdashengine.h"
 #include "chargingsessionsdbusinterfaceclient.h"
 #include "energymanagerdbusclient.h"
+#include "evdashchargerfields.h"
+#include "evdashsessionstore.h"
 #include "evdashsettings.h"
+#include "evdashsettingsstore.h"
+#include "evdashstatistics.h"
+#include "evdashtlssessioncache.h"
+#include "evdashtracer.h"
 #include "evdashwebserverresource.h"
+#include "evdashwebsocketserver.h"
 
+#include <integrations/thingactioninfo.h>
 #include <integrations/thingmanager.h>
 #include <logging/logengine.h>
-
+#include <nymeasettings.h>
+#include <types/action.h>
+
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QDBusConnection>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QHostAddress>
-#include <QWebSocket>
+#include <QSaveFile>
+#include <QSslCertificate>
+#include <QSslConfiguration>
+#include <QSslKey>
+#include <QSslSocket>
+#include <QThread>
 #include <QWebSocketProtocol>
-#include <QWebSocketServer>
 
 #include <QDateTime>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QJsonParseError>
+#include <QMetaEnum>
+#include <QTimer>
 #include <QUuid>
 
+#include <algorithm>
+
 #include <QLoggingCategory>
 Q_DECLARE_LOGGING_CATEGORY(dcEvDashExperience)
 
-EvDashEngine::EvDashEngine(ThingManager *thingManager, LogEngine *logEngine, EvDashWebServerResource *webServerResource, QObject *parent)
+// Request latency is recorded per action, anything else ends up in one bucket
+static const QStringList s_requestMetricActions = {QStringLiteral("authenticate"), QStringLiteral("ping"), QStringLiteral("Batch"), QStringLiteral("Subscribe"), QStringLiteral("ExecuteChargerActions"), QStringLiteral("GetSnapshot"), QStringLiteral("GetGroups"), QStringLiteral("GetChargers"), QStringLiteral("GetCars"), QStringLiteral("GetChargingSessions")};
+
+static QString requestMetricLabel(const QString &action)
+{
+    for (const QString &knownAction : s_requestMetricActions) {
+        if (action.compare(knownAction, Qt::CaseInsensitive) == 0)
+            return knownAction;
+    }
+
+    return QStringLiteral("unknown");
+}
+
+// Clients choose their request ids independently, so charger actions are pending per client
+static QString chargerActionsKey(quint64 clientId, const QString &requestId)
+{
+    return QStringLiteral("%1:%2").arg(clientId).arg(requestId);
+}
+
+// Flush intervals of rate limited clients in ms
+static const int s_minRateClassInterval = 100;
+static const int s_maxRateClassInterval = 60000;
+
+// Sessions listed in the snapshot summary
+static const int s_recentSessionsCount = 10;
+
+// The group containing every charger, it cannot be changed or removed
+static const QString s_allChargersGroupId = QStringLiteral("all");
+
+// Charger error states reported while everything is fine
+static bool isChargerErrorValue(const QString &error)
+{
+    static const QStringList noErrorValues = {QString(), QStringLiteral("none"), QStringLiteral("noerror"), QStringLiteral("no error"), QStringLiteral("0")};
+    return !noErrorValues.contains(error.trimmed().toLower());
+}
+
+// The energy services live on the system bus. For testing the clients can be
+// pointed to the session bus or to a private bus daemon instead.
+static QDBusConnection energyServicesConnection()
+{
+    EvDashSettings settings;
+    settings.beginGroup("DBus");
+    const QString bus = settings.value("bus", "system").toString();
+    const QString address = settings.value("address").toString();
+    settings.endGroup();
+
+    if (bus == QStringLiteral("session")) {
+        qCInfo(dcEvDashExperience()) << "Using the DBus session bus for the energy services";
+        return QDBusConnection::sessionBus();
+    }
+
+    if (bus == QStringLiteral("address")) {
+        if (!address.isEmpty()) {
+            qCInfo(dcEvDashExperience()) << "Using the DBus bus at" << address << "for the energy services";
+            return QDBusConnection::connectToBus(address, QStringLiteral("evdash-energy-services"));
+        }
+
+        qCWarning(dcEvDashExperience()) << "DBus bus address not configured. Falling back to the system bus.";
+    } else if (bus != QStringLiteral("system")) {
+        qCWarning(dcEvDashExperience()) << "Unknown DBus bus" << bus << "configured. Falling back to the system bus.";
+    }
+
+    return QDBusConnection::systemBus();
+}
+
+EvDashEngine::EvDashEngine(ThingManager *thingManager, LogEngine *logEngine, EvDashWebServerResource *webServerResource, EvDashSettingsStore *settingsStore, EvDashStatistics *statistics, QObject *parent)
     : QObject{parent}
     , m_thingManager{thingManager}
     , m_logEngine{logEngine}
     , m_webServerResource{webServerResource}
+    , m_settingsStore{settingsStore}
+    , m_statistics{statistics}
+{
+    loadGroups();
+
+    EvDashSettings settings;
+    settings.beginGroup("General");
+    m_webSocketPort = settings.value("webSocketServerPort", 4449).toUInt();
+    bool enabled = settings.value("enabled", false).toBool();
+    settings.endGroup();
+
+    settings.beginGroup("WebSocket");
+    m_authenticationTimeout = qMax(1000, settings.value("authenticationTimeout", m_authenticationTimeout).toInt());
+    m_replayLogSize = qMax(0, settings.value("replayLogSize", m_replayLogSize).toInt());
+    m_replayLogMaxBytes = qMax<qint64>(0, settings.value("replayLogMaxBytes", m_replayLogMaxBytes).toLongLong());
+    m_maxBatchSize = qMax(1, settings.value("maxBatchSize", m_maxBatchSize).toInt());
+    settings.endGroup();
+
+    settings.beginGroup("ChargerActions");
+    m_chargerActionsEnabled = settings.value("enabled", false).toBool();
+    m_chargerActionsTimeout = qMax(1000, settings.value("timeout", m_chargerActionsTimeout).toInt());
+    m_maxChargerActions = qMax(1, settings.value("maxActions", m_maxChargerActions).toInt());
+    settings.endGroup();
+
+    m_notificationEpoch = QUuid::createUuid().toString(QUuid::WithoutBraces);
+
+    // Opt-in request tracing, see the Tracing settings group
+    m_tracer = new EvDashTracer(this);
+
+    m_statistics->setValueProvider("evdash_websocket_clients", QString(), [this]() { return m_clients.count(); });
+    m_statistics->setValueProvider("evdash_websocket_authenticated_clients", QString(), [this]() {
+        int authenticatedClients = 0;
+        for (const QString &token : qAsConst(m_authenticatedClients)) {
+            if (!token.isEmpty())
+                authenticatedClients++;
+        }
+        return authenticatedClients;
+    });
+    m_statistics->setValueProvider("evdash_websocket_workers", QString(), [this]() { return m_webSocketServer && m_webSocketServer->isListening() ? m_webSocketServer->workerCount() : 0; });
+    m_statistics->setValueProvider("evdash_websocket_send_queue_depth", QString(), [this]() { return m_webSocketServer ? m_webSocketServer->queueDepth() : 0; });
+    m_statistics->setValueProvider("evdash_pending_session_requests", QString(), [this]() { return m_pendingChargingSessionsRequests.count(); });
+    m_statistics->setValueProvider("evdash_replay_log_entries", QString(), [this]() { return m_replayLog.count(); });
+    m_statistics->setValueProvider("evdash_websocket_rate_classes", QString(), [this]() { return m_rateClasses.count(); });
+    m_statistics->setValueProvider("evdash_settings_commits_total", QString(), [this]() { return m_settingsStore->commits(); });
+
+    // Everything else is only set up while the service is enabled. The state has
+    // just been read from the settings, there is nothing to write back.
+    applyEnabled(enabled);
+}
+
+EvDashEngine::~EvDashEngine()
+{
+    // The statistics and settings store are owned by the plugin and may be gone already
+    saveWarmStart();
+    stopWebSocketServer();
+    delete m_sessionStore;
+}
+
+bool EvDashEngine::enabled() const
+{
+    return m_enabled;
+}
+
+bool EvDashEngine::setEnabled(bool enabled)
+{
+    if (!applyEnabled(enabled))
+        return false;
+
+    m_settingsStore->setValue(QStringLiteral("General/enabled"), enabled);
+    return true;
+}
+
+bool EvDashEngine::applyEnabled(bool enabled)
 {
+    const bool wasEnabled = m_enabled;
+    m_enabled = enabled;
+
+    if (m_enabled) {
+        startServices();
+        if (!startWebSocketServer(m_webSocketPort)) {
+            // Nothing keeps running without the WebSocket server, the service stays disabled
+            qCWarning(dcEvDashExperience()) << "Could not enable the EV Dash service because the WebSocket server did not start";
+            stopServices();
+            m_enabled = false;
+            m_webServerResource->setEnabled(false);
+            if (wasEnabled)
+                emit enabledChanged(false);
+
+            return false;
+        }
+    } else {
+        stopServices();
+    }
+
+    qCDebug(dcEvDashExperience()) << "The EV Dash service is now" << (enabled ? "enabled" : "disabled");
+    m_webServerResource->setEnabled(m_enabled);
+
+    emit enabledChanged(m_enabled);
+    return true;
+}
+
+void EvDashEngine::startServices()
+{
+    if (m_servicesStarted)
+        return;
+
+    qCDebug(dcEvDashExperience()) << "Starting the EV Dash services";
+    m_servicesStarted = true;
+
+    // Things
     Things configuredThings = m_thingManager->configuredThings();
     foreach (Thing *thing, configuredThings) {
         if (isChargerThing(thing)) {
@@ -69,49 +267,105 @@ EvDashEngine::EvDashEngine(ThingManager *thingManager, LogEngine *logEngine, EvD
     connect(m_thingManager, &ThingManager::thingRemoved, this, &EvDashEngine::onThingRemoved);
     connect(m_thingManager, &ThingManager::thingChanged, this, &EvDashEngine::onThingChanged);
 
-    // Setup websocket server
-    m_webSocketServer = new QWebSocketServer(QStringLiteral("EvDashEngine"), QWebSocketServer::NonSecureMode, this);
-
-    connect(m_webSocketServer, &QWebSocketServer::newConnection, this, [this]() {
-        QWebSocket *socket = m_webSocketServer->nextPendingConnection();
-        if (!socket) {
-            qCWarning(dcEvDashExperience()) << "Interface: Received new connection but socket was null";
-            return;
-        }
+    rebuildGroups();
 
-        connect(socket, &QWebSocket::textMessageReceived, this, [this, socket](const QString &message) { processTextMessage(socket, message); });
+    EvDashSettings settings;
+    settings.beginGroup("WebSocket");
+    const int pingInterval = qMax(1000, settings.value("pingInterval", 30000).toInt());
+    // The pong has to arrive before the next ping goes out
+    const int pongTimeout = qBound(500, settings.value("pongTimeout", 10000).toInt(), pingInterval - 500);
+    const int maxClients = qMax(1, settings.value("maxClients", 64).toInt());
+    const int maxClientsPerAddress = qMax(1, settings.value("maxClientsPerAddress", 8).toInt());
+    const int workerThreads = qMax(1, settings.value("workerThreads", qBound(1, QThread::idealThreadCount(), 4)).toInt());
+    const bool sslEnabled = settings.value("sslEnabled", false).toBool();
+    settings.endGroup();
 
-        connect(socket, &QWebSocket::disconnected, this, [this, socket]() {
-            m_clients.removeAll(socket);
-            m_authenticatedClients.remove(socket);
-            qCDebug(dcEvDashExperience()) << "WebSocket client disconnected" << socket->peerAddress().toString() << "Remaining clients:" << m_clients.count();
-            socket->deleteLater();
-        });
+    // Setup websocket server. Socket I/O happens in worker threads, requests and events are handled in this thread.
+    m_webSocketServer = new EvDashWebSocketServer(this);
+    m_webSocketServer->setTracer(m_tracer);
+    m_webSocketServer->setWorkerCount(workerThreads);
+    m_webSocketServer->setHeartbeat(pingInterval, pongTimeout);
+    m_webSocketServer->setConnectionLimits(maxClients, maxClientsPerAddress);
+
+    // Never fall back to cleartext, the login tokens would be exposed
+    m_webSocketTlsError = false;
+    if (sslEnabled) {
+        QSslConfiguration sslConfiguration;
+        if (loadSslConfiguration(&sslConfiguration)) {
+            m_webSocketServer->setSslConfiguration(sslConfiguration);
+            qCInfo(dcEvDashExperience()) << "WebSocket server will use TLS";
+        } else {
+            qCWarning(dcEvDashExperience()) << "TLS has been enabled for the WebSocket server but no valid certificate could be loaded. The WebSocket server will not be started.";
+            m_webSocketTlsError = true;
+        }
+    }
 
-        m_clients.append(socket);
-        m_authenticatedClients.insert(socket, QString());
-        qCDebug(dcEvDashExperience()) << "WebSocket client connected" << socket->peerAddress().toString() << "Total clients:" << m_clients.count();
-    });
+    connect(m_webSocketServer, &EvDashWebSocketServer::clientConnected, this, &EvDashEngine::onClientConnected);
+    connect(m_webSocketServer, &EvDashWebSocketServer::clientDisconnected, this, &EvDashEngine::onClientDisconnected);
+    connect(m_webSocketServer, &EvDashWebSocketServer::requestReceived, this, &EvDashEngine::processRequest);
+    connect(m_webSocketServer, &EvDashWebSocketServer::invalidRequestReceived, this, &EvDashEngine::onInvalidRequest);
 
-    connect(m_webSocketServer, &QWebSocketServer::acceptError, this, [this](QAbstractSocket::SocketError error) {
-        qCWarning(dcEvDashExperience()) << "WebSocket accept error" << error << m_webSocketServer->errorString();
-    });
+    if (m_webSocketServer->tlsSessionCache()) {
+        EvDashTlsSessionCache *sessionCache = m_webSocketServer->tlsSessionCache();
+        m_statistics->setValueProvider("evdash_tls_handshakes_total", QStringLiteral("full"), [sessionCache]() { return sessionCache->fullHandshakes(); });
+        m_statistics->setValueProvider("evdash_tls_handshakes_total", QStringLiteral("resumed"), [sessionCache]() { return sessionCache->resumedHandshakes(); });
+    }
 
-    EvDashSettings settings;
-    settings.beginGroup("General");
-    m_webSocketPort = settings.value("webSocketServerPort", 4449).toUInt();
-    bool enabled = settings.value("enabled", false).toBool();
-    settings.endGroup();
+    const QDBusConnection energyServicesBus = energyServicesConnection();
 
     // ChargingSessions client for fetching charging sessions
-    m_chargingSessionsClient = new ChargingSessionsDBusInterfaceClient(this);
+    m_chargingSessionsClient = new ChargingSessionsDBusInterfaceClient(energyServicesBus, this);
     connect(m_chargingSessionsClient, &ChargingSessionsDBusInterfaceClient::sessionsReceived, this, &EvDashEngine::onSessionsReceived);
 
     connect(m_chargingSessionsClient, &ChargingSessionsDBusInterfaceClient::errorOccurred, this, &EvDashEngine::onSessionsError);
+    connect(m_chargingSessionsClient, &ChargingSessionsDBusInterfaceClient::callFinished, this, [this](const QString &method, qint64 durationNanoseconds, bool success) {
+        const QString call = QStringLiteral("chargingsessions.") + method;
+        m_statistics->observeDuration("evdash_dbus_call_duration_seconds", call, durationNanoseconds);
+        if (!success)
+            m_statistics->incrementCounter("evdash_dbus_call_errors_total", call);
+    });
+
+    settings.beginGroup("SessionStore");
+    const bool sessionStoreEnabled = settings.value("enabled", true).toBool();
+    const QString sessionStorePath = settings.value("path", NymeaSettings::storagePath() + "/evdash-sessions.dat").toString();
+    m_sessionSyncOverlap = qMax<qint64>(0, settings.value("syncOverlap", m_sessionSyncOverlap).toLongLong());
+    settings.endGroup();
+
+    if (sessionStoreEnabled) {
+        m_sessionStore = new EvDashSessionStore(sessionStorePath);
+        if (m_sessionStore->open()) {
+            // Sessions known from the last run can be served right away, the sync catches up in the background
+            m_sessionStoreSynced = m_sessionStore->count() > 0;
+            m_sessionsSummary = createStoreSummary();
+            m_statistics->setValueProvider("evdash_session_store_sessions", QString(), [this]() { return m_sessionStore->count(); });
+            requestSessionSync();
+        } else {
+            qCWarning(dcEvDashExperience()) << "Session store not available, fetching the complete session history for every request";
+            delete m_sessionStore;
+            m_sessionStore = nullptr;
+        }
+    }
 
     // Energy manager client for associated cars and current mode
-    m_energyManagerClient = new EnergyManagerDbusClient(this);
-    connect(m_energyManagerClient, &EnergyManagerDbusClient::chargingInfosUpdated, this, [](const QVariantList &chargingInfos) {
+    m_energyManagerClient = new EnergyManagerDbusClient(energyServicesBus, this);
+    connect(m_energyManagerClient, &EnergyManagerDbusClient::callFinished, this, [this](const QString &method, qint64 durationNanoseconds, bool success) {
+        const QString call = QStringLiteral("energymanager.") + method;
+        m_statistics->observeDuration("evdash_dbus_call_duration_seconds", call, durationNanoseconds);
+        if (!success)
+            m_statistics->incrementCounter("evdash_dbus_call_errors_total", call);
+    });
+    connect(m_energyManagerClient, &EnergyManagerDbusClient::chargingInfosUpdated, this, [this](const QVariantList &chargingInfos) {
+        markStateChanged();
+        if (m_chargingInfosStale) {
+            qCDebug(dcEvDashExperience()) << "Charging infos received, replacing the warm start assignments";
+            m_chargingInfosStale = false;
+            m_warmStartChargingInfos.clear();
+            rebuildChargerAssignments();
+            for (Thing *charger : qAsConst(m_chargers))
+                notifyChargerChanged(charger);
+        } else {
+            rebuildChargerAssignments();
+        }
         qCDebug(dcEvDashExperience()) << "ChargingInfos:";
         foreach (const QVariant &ciVariant, chargingInfos) {
             qCDebug(dcEvDashExperience()) << "-->" << ciVariant.toMap();
@@ -120,6 +374,10 @@ EvDashEngine::EvDashEngine(ThingManager *thingManager, LogEngine *logEngine, EvD
 
     connect(m_energyManagerClient, &EnergyManagerDbusClient::chargingInfoAdded, this, [this](const QVariantMap &chargingInfo) {
         qCDebug(dcEvDashExperience()) << "ChargingInfo added:" << chargingInfo;
+        // While the warm start assignments are in use, the full list replaces them
+        if (!m_chargingInfosStale)
+            updateChargerAssignment(chargingInfo);
+
         Thing *charger = m_thingManager->findConfiguredThing(chargingInfo.value("evChargerId").toUuid());
         if (charger) {
             onThingChanged(charger);
@@ -128,14 +386,20 @@ EvDashEngine::EvDashEngine(ThingManager *thingManager, LogEngine *logEngine, EvD
 
     connect(m_energyManagerClient, &EnergyManagerDbusClient::chargingInfoChanged, this, [this](const QVariantMap &chargingInfo) {
         qCDebug(dcEvDashExperience()) << "ChargingInfo changed:" << chargingInfo;
+        if (!m_chargingInfosStale)
+            updateChargerAssignment(chargingInfo);
+
         Thing *charger = m_thingManager->findConfiguredThing(chargingInfo.value("evChargerId").toUuid());
         if (charger) {
             onThingChanged(charger);
         }
     });
 
-    connect(m_energyManagerClient, &EnergyManagerDbusClient::chargingInfoRemoved, this, [](const QString &evChargerId) {
+    connect(m_energyManagerClient, &EnergyManagerDbusClient::chargingInfoRemoved, this, [this](const QString &evChargerId) {
+        markStateChanged();
         qCDebug(dcEvDashExperience()) << "ChargingInfo removed:" << evChargerId;
+        if (!m_chargingInfosStale)
+            m_chargerAssignments.remove(QUuid::fromString(evChargerId));
     });
 
     connect(m_energyManagerClient, &EnergyManagerDbusClient::errorOccurred, this, [](const QString &errorMessage) {
@@ -147,50 +411,299 @@ EvDashEngine::EvDashEngine(ThingManager *thingManager, LogEngine *logEngine, EvD
         qCDebug(dcEvDashExperience()) << "-->" << ciVariant.toMap();
     }
 
-    // Start the service if enabled
-    setEnabled(enabled);
+    // Restore what is known from the last run, the sources are queried in the background
+    settings.beginGroup("WarmStart");
+    if (settings.value("enabled", true).toBool())
+        m_warmStartFileName = settings.value("path", NymeaSettings::storagePath() + "/evdash-warmstart.cbor").toString();
+    const int warmStartSaveInterval = qMax(10, settings.value("saveInterval", 300).toInt());
+    settings.endGroup();
+
+    if (!m_warmStartFileName.isEmpty()) {
+        loadWarmStart();
+
+        m_warmStartTimer = new QTimer(this);
+        m_warmStartTimer->setInterval(warmStartSaveInterval * 1000);
+        connect(m_warmStartTimer, &QTimer::timeout, this, &EvDashEngine::saveWarmStart);
+        m_warmStartTimer->start();
+    }
+
+    rebuildChargerAssignments();
+    loadDeadbands();
 }
 
-EvDashEngine::~EvDashEngine()
+void EvDashEngine::stopServices()
 {
+    if (!m_servicesStarted)
+        return;
+
+    qCDebug(dcEvDashExperience()) << "Stopping the EV Dash services";
+    m_servicesStarted = false;
+
+    saveWarmStart();
+    delete m_warmStartTimer;
+    m_warmStartTimer = nullptr;
+    m_warmStartFileName.clear();
+    m_warmStartChargingInfos.clear();
+    m_chargingInfosStale = false;
+    m_chargerAssignments.clear();
+
+    delete m_deadbandRefreshTimer;
+    m_deadbandRefreshTimer = nullptr;
+    m_deadbands.clear();
+
     stopWebSocketServer();
+    m_statistics->removeLabel("evdash_tls_handshakes_total", QStringLiteral("full"));
+    m_statistics->removeLabel("evdash_tls_handshakes_total", QStringLiteral("resumed"));
+    delete m_webSocketServer;
+    m_webSocketServer = nullptr;
+
+    // Sequence numbers continue, resuming clients get a snapshot after the gap
+    m_replayLog.clear();
+    m_replayLogBytes = 0;
+
+    m_statistics->removeLabel("evdash_session_store_sessions", QString());
+    delete m_sessionStore;
+    m_sessionStore = nullptr;
+    m_sessionStoreSynced = false;
+    m_sessionSyncInFlight = false;
+
+    delete m_chargingSessionsClient;
+    m_chargingSessionsClient = nullptr;
+    delete m_energyManagerClient;
+    m_energyManagerClient = nullptr;
+
+    disconnect(m_thingManager, nullptr, this, nullptr);
+    for (Thing *thing : qAsConst(m_chargers))
+        disconnect(thing, nullptr, this, nullptr);
+    for (Thing *thing : qAsConst(m_cars))
+        disconnect(thing, nullptr, this, nullptr);
+
+    m_chargers.clear();
+    m_cars.clear();
+    m_chargersStatusChangedCache.clear();
+    m_chargerPayloads.clear();
+    m_chargerStateTypeIds.clear();
+    m_staleStatusUpdates.clear();
+    rebuildGroups();
+    markStateChanged();
 }
 
-bool EvDashEngine::enabled() const
+QByteArray EvDashEngine::stateETag() const
 {
-    return m_enabled;
+    // The epoch keeps tags unique across restarts, the version starts over then
+    return QStringLiteral("\"%1-%2\"").arg(m_notificationEpoch.left(8)).arg(m_stateVersion).toUtf8();
 }
 
-bool EvDashEngine::setEnabled(bool enabled)
+QByteArray EvDashEngine::encodedState(const QString &resource, bool *found)
 {
-    m_enabled = enabled;
+    updateSnapshot();
+    if (m_restCacheVersion != m_stateVersion) {
+        m_restCache.clear();
+        m_restCacheVersion = m_stateVersion;
+    }
 
-    if (m_enabled) {
-        if (!startWebSocketServer(m_webSocketPort)) {
-            return false;
+    auto it = m_restCache.constFind(resource);
+    if (it != m_restCache.constEnd()) {
+        *found = true;
+        return it.value();
+    }
+
+    QJsonObject object;
+    if (resource == QStringLiteral("chargers")) {
+        object.insert(QStringLiteral("chargers"), m_snapshot.value(QStringLiteral("chargers")));
+    } else if (resource == QStringLiteral("cars")) {
+        object.insert(QStringLiteral("cars"), m_snapshot.value(QStringLiteral("cars")));
+    } else if (resource.startsWith(QStringLiteral("chargers/"))) {
+        const QUuid chargerId = QUuid::fromString(resource.mid(9));
+        const QJsonArray chargers = m_snapshot.value(QStringLiteral("chargers")).toArray();
+        for (const QJsonValue &charger : chargers) {
+            if (!chargerId.isNull() && QUuid::fromString(charger.toObject().value(QStringLiteral("id")).toString()) == chargerId) {
+                object.insert(QStringLiteral("charger"), charger);
+                break;
+            }
+        }
+    }
+
+    *found = !object.isEmpty();
+    if (!*found)
+        return QByteArray();
+
+    const QByteArray data = QJsonDocument(object).toJson(QJsonDocument::Compact);
+    m_restCache.insert(resource, data);
+    return data;
+}
+
+QString EvDashEngine::epoch() const
+{
+    return m_notificationEpoch;
+}
+
+quint64 EvDashEngine::stateVersion() const
+{
+    return m_stateVersion;
+}
+
+QJsonObject EvDashEngine::changesSince(quint64 version, const QString &epoch)
+{
+    QJsonObject changes;
+    changes.insert(QStringLiteral("epoch"), m_notificationEpoch);
+    changes.insert(QStringLiteral("version"), static_cast<qint64>(m_stateVersion));
+
+    // Versions from another engine instance or beyond the remembered removals cannot be diffed
+    const bool reset = version == 0 || epoch != m_notificationEpoch || version > m_stateVersion || version < m_removedThingsHorizon;
+    changes.insert(QStringLiteral("reset"), reset);
+
+    QJsonArray chargerList;
+    for (Thing *charger : qAsConst(m_chargers)) {
+        if (reset || m_thingVersions.value(charger->id()) > version)
+            chargerList.append(packCharger(charger));
+    }
+
+    QJsonArray carList;
+    for (Thing *car : qAsConst(m_cars)) {
+        if (reset || m_thingVersions.value(car->id()) > version)
+            carList.append(packCar(car));
+    }
+
+    QJsonArray removed;
+    if (!reset) {
+        for (auto it = m_removedThings.constBegin(); it != m_removedThings.constEnd(); ++it) {
+            if (it.value() > version)
+                removed.append(it.key().toString(QUuid::WithoutBraces));
+        }
+    }
+
+    changes.insert(QStringLiteral("chargers"), chargerList);
+    changes.insert(QStringLiteral("cars"), carList);
+    changes.insert(QStringLiteral("removed"), removed);
+    return changes;
+}
+
+QVariantList EvDashEngine::groups() const
+{
+    return packGroups().toVariantList();
+}
+
+EvDashEngine::EvDashError EvDashEngine::setGroup(const QString &groupId, const QString &name, const QStringList &chargerIds, QString *resultGroupId)
+{
+    if (groupId == s_allChargersGroupId || name.trimmed().isEmpty())
+        return EvDashErrorInvalidGroup;
+
+    QStringList normalizedChargerIds;
+    for (const QString &chargerId : chargerIds) {
+        const QUuid chargerUuid = QUuid::fromString(chargerId);
+        if (chargerUuid.isNull()) {
+            qCWarning(dcEvDashExperience()) << "Cannot set group" << name << "because of the invalid charger id" << chargerId;
+            return EvDashErrorInvalidGroup;
         }
+
+        const QString normalizedChargerId = chargerUuid.toString(QUuid::WithoutBraces);
+        if (!normalizedChargerIds.contains(normalizedChargerId))
+            normalizedChargerIds.append(normalizedChargerId);
+    }
+
+    ChargerGroup group;
+    if (groupId.isEmpty()) {
+        group.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    } else if (m_groups.contains(groupId)) {
+        group = m_groups.value(groupId);
     } else {
-        stopWebSocketServer();
+        return EvDashErrorGroupNotFound;
     }
 
-    qCDebug(dcEvDashExperience()) << "The EV Dash service is now" << (enabled ? "enabled" : "disabled");
-    m_webServerResource->setEnabled(m_enabled);
+    for (const QString &chargerId : qAsConst(group.chargerIds))
+        m_chargerGroups[ThingId(chargerId)].removeAll(group.id);
 
-    EvDashSettings settings;
-    settings.beginGroup("General");
-    settings.setValue("enabled", enabled);
-    settings.endGroup();
+    group.name = name.trimmed();
+    group.chargerIds = normalizedChargerIds;
+    for (const QString &chargerId : qAsConst(group.chargerIds))
+        m_chargerGroups[ThingId(chargerId)].append(group.id);
 
-    emit enabledChanged(m_enabled);
-    return true;
+    rebuildGroup(group);
+    m_groups.insert(group.id, group);
+
+    m_settingsStore->setValue(QStringLiteral("Groups/%1/name").arg(group.id), group.name);
+    m_settingsStore->setValue(QStringLiteral("Groups/%1/chargers").arg(group.id), group.chargerIds);
+
+    qCDebug(dcEvDashExperience()) << "Group" << group.name << "set with" << group.chargerIds.count() << "chargers";
+    if (resultGroupId)
+        *resultGroupId = group.id;
+
+    markStateChanged();
+    emit groupsChanged();
+    sendNotification(QStringLiteral("GroupChanged"), packGroup(group));
+    return EvDashErrorNoError;
+}
+
+EvDashEngine::EvDashError EvDashEngine::removeGroup(const QString &groupId)
+{
+    if (groupId == s_allChargersGroupId)
+        return EvDashErrorInvalidGroup;
+
+    if (!m_groups.contains(groupId))
+        return EvDashErrorGroupNotFound;
+
+    const ChargerGroup group = m_groups.take(groupId);
+    for (const QString &chargerId : group.chargerIds)
+        m_chargerGroups[ThingId(chargerId)].removeAll(groupId);
+
+    m_settingsStore->remove(QStringLiteral("Groups/%1").arg(groupId));
+
+    qCDebug(dcEvDashExperience()) << "Group" << group.name << "removed";
+
+    markStateChanged();
+    emit groupsChanged();
+    sendNotification(QStringLiteral("GroupRemoved"), QJsonObject{{QStringLiteral("id"), groupId}});
+    return EvDashErrorNoError;
+}
+
+void EvDashEngine::markStateChanged()
+{
+    m_stateVersion++;
+    emit stateChanged(m_stateVersion);
+}
+
+void EvDashEngine::markThingChanged(Thing *thing)
+{
+    m_stateVersion++;
+    m_thingVersions.insert(thing->id(), m_stateVersion);
+    m_removedThings.remove(thing->id());
+    emit stateChanged(m_stateVersion);
+}
+
+void EvDashEngine::markThingRemoved(const ThingId &thingId)
+{
+    m_stateVersion++;
+    m_thingVersions.remove(thingId);
+    m_removedThings.insert(thingId, m_stateVersion);
+
+    // Forget the oldest removals, clients behind them get a full reset
+    while (m_removedThings.count() > s_maxRemovedThings) {
+        auto oldest = m_removedThings.begin();
+        for (auto it = m_removedThings.begin(); it != m_removedThings.end(); ++it) {
+            if (it.value() < oldest.value())
+                oldest = it;
+        }
+
+        m_removedThingsHorizon = qMax(m_removedThingsHorizon, oldest.value());
+        m_removedThings.erase(oldest);
+    }
+
+    emit stateChanged(m_stateVersion);
 }
 
 void EvDashEngine::onThingAdded(Thing *thing)
 {
+    if (isChargerThing(thing) || isCarThing(thing))
+        markThingChanged(thing);
+
     if (isChargerThing(thing)) {
         m_chargers.append(thing);
         monitorChargerThing(thing);
-        sendNotification("ChargerAdded", packCharger(thing));
+        const EvDashChargerFields::Values chargerValues = packChargerValues(thing);
+        m_chargerPayloads.insert(thing->id(), chargerValues);
+        sendNotification("ChargerAdded", EvDashChargerFields::toJson(chargerValues), QString(), EvDashChargerFields::s_allFields, chargerValues);
+        updateChargerAggregates(thing);
         verifyChargerStatusChanged(thing);
     }
 
@@ -206,9 +719,14 @@ void EvDashEngine::onThingRemoved(const ThingId &thingId)
     foreach (Thing *thing, m_chargers) {
         if (thing->id() == thingId) {
             qCDebug(dcEvDashExperience()) << "Charger has been removed.";
-            sendNotification("ChargerRemoved", packCharger(thing));
+            const EvDashChargerFields::Values chargerValues = packChargerValues(thing);
+            sendNotification("ChargerRemoved", EvDashChargerFields::toJson(chargerValues), QString(), EvDashChargerFields::s_allFields, chargerValues);
             m_chargers.removeAll(thing);
             m_chargersStatusChangedCache.remove(thing);
+            m_chargerPayloads.remove(thingId);
+            m_staleStatusUpdates.remove(thingId);
+            markThingRemoved(thingId);
+            removeChargerAggregates(thingId);
             break;
         }
     }
@@ -217,6 +735,7 @@ void EvDashEngine::onThingRemoved(const ThingId &thingId)
         if (thing->id() == thingId) {
             qCDebug(dcEvDashExperience()) << "Car has been removed.";
             m_cars.removeAll(thing);
+            markThingRemoved(thingId);
             sendNotification("CarRemoved", packCar(thing));
             break;
         }
@@ -226,12 +745,81 @@ void EvDashEngine::onThingRemoved(const ThingId &thingId)
 void EvDashEngine::onThingChanged(Thing *thing)
 {
     if (isChargerThing(thing)) {
-        sendNotification("ChargerChanged", packCharger(thing));
+        notifyChargerChanged(thing);
+        updateChargerAggregates(thing);
         verifyChargerStatusChanged(thing);
     }
 
-    if (isCarThing(thing))
+    if (isCarThing(thing)) {
+        markThingChanged(thing);
         sendNotification("CarChanged", packCar(thing));
+    }
+}
+
+void EvDashEngine::notifyChargerChanged(Thing *charger, const QString &traceId, bool applyDeadbands)
+{
+    EvDashChargerFields::Values chargerValues = packChargerValues(charger);
+    auto previous = m_chargerPayloads.find(charger->id());
+
+    // Small changes keep the last sent value, so slow drifts still add up to a change
+    if (applyDeadbands && previous != m_chargerPayloads.end()) {
+        for (auto it = m_deadbands.constBegin(); it != m_deadbands.constEnd(); ++it) {
+            const QJsonValue lastValue = previous.value().at(it.key());
+            const QJsonValue value = chargerValues.at(it.key());
+            if (!lastValue.isDouble() || !value.isDouble() || lastValue == value)
+                continue;
+
+            const double band = qMax(it.value().absolute, it.value().relative * qAbs(lastValue.toDouble()));
+            if (qAbs(value.toDouble() - lastValue.toDouble()) <= band) {
+                chargerValues[it.key()] = lastValue;
+                m_statistics->incrementCounter("evdash_deadband_suppressed_total", EvDashChargerFields::fieldNames().at(it.key()));
+            }
+        }
+    }
+
+    const quint32 changedFields = previous == m_chargerPayloads.end() ? EvDashChargerFields::s_allFields : EvDashChargerFields::changedFields(previous.value(), chargerValues);
+    if (changedFields == 0)
+        return;
+
+    m_chargerPayloads.insert(charger->id(), chargerValues);
+    markThingChanged(charger);
+    sendNotification("ChargerChanged", EvDashChargerFields::toJson(chargerValues), traceId, changedFields, chargerValues);
+}
+
+void EvDashEngine::loadDeadbands()
+{
+    // Only numeric state fields can have a deadband
+    static const QHash<QString, Deadband> defaultDeadbands = {{QStringLiteral("currentPower"), {10, 0.01}}, {QStringLiteral("temperature"), {0.5, 0}}};
+
+    EvDashSettings settings;
+    settings.beginGroup("Deadbands");
+    for (int index = 0; index < EvDashChargerFields::s_stateFieldCount; index++) {
+        const int bit = EvDashChargerFields::DerivedFieldCount + index;
+        const QString key = EvDashChargerFields::fieldNames().at(bit);
+        const Deadband defaultDeadband = defaultDeadbands.value(key);
+        Deadband deadband;
+        deadband.absolute = qMax(0.0, settings.value(key + "/absolute", defaultDeadband.absolute).toDouble());
+        deadband.relative = qMax(0.0, settings.value(key + "/relative", defaultDeadband.relative).toDouble());
+        if (deadband.absolute > 0 || deadband.relative > 0)
+            m_deadbands.insert(bit, deadband);
+    }
+    const int refreshInterval = qMax(0, settings.value("refreshInterval", 60).toInt());
+    settings.endGroup();
+
+    if (m_deadbands.isEmpty() || refreshInterval == 0)
+        return;
+
+    m_deadbandRefreshTimer = new QTimer(this);
+    m_deadbandRefreshTimer->setInterval(refreshInterval * 1000);
+    connect(m_deadbandRefreshTimer, &QTimer::timeout, this, &EvDashEngine::refreshChargers);
+    m_deadbandRefreshTimer->start();
+}
+
+void EvDashEngine::refreshChargers()
+{
+    // Values held back by a deadband are sent now if they still differ
+    for (Thing *charger : qAsConst(m_chargers))
+        notifyChargerChanged(charger, QString(), false);
 }
 
 void EvDashEngine::monitorChargerThing(Thing *thing)
@@ -270,119 +858,357 @@ void EvDashEngine::verifyChargerStatusChanged(Thing *charger)
 {
     QString stateName = "status";
     QString source = QString("state-%1-%2").arg(charger->id().toString(QUuid::WithBraces), stateName);
+    QElapsedTimer fetchTimer;
+    fetchTimer.start();
+    const qint64 traceStart = m_tracer->enabled() ? EvDashTracer::now() : 0;
     LogFetchJob *job = m_logEngine->fetchLogEntries({source}, {stateName}, {}, {}, {}, Types::SampleRateAny, Qt::DescendingOrder, 0, 1);
-    connect(job, &LogFetchJob::finished, charger, [this, charger, stateName](const LogEntries &entries) {
+    connect(job, &LogFetchJob::finished, charger, [this, charger, stateName, fetchTimer, traceStart](const LogEntries &entries) {
+        m_statistics->observeDuration("evdash_logengine_fetch_duration_seconds", QString(), fetchTimer.nsecsElapsed());
+
+        // The service may have been disabled in the meantime
+        if (!m_chargers.contains(charger))
+            return;
+
+        // The resulting notification continues the trace of the log fetch
+        QString traceId;
+        if (m_tracer->enabled()) {
+            traceId = QUuid::createUuid().toString(QUuid::WithoutBraces);
+            m_tracer->addSpan(traceId, QStringLiteral("logfetch"), traceStart, EvDashTracer::now(), {{"charger", charger->name()}});
+        }
+
+        // A restored timestamp is confirmed or replaced now, either way it is no longer stale
+        const bool wasStale = m_staleStatusUpdates.remove(charger->id());
+
         if (entries.isEmpty()) {
             qCDebug(dcEvDashExperience()) << "Last state change of" << charger->name() << stateName << "unknown";
             // Forget any cached values, the database did not return any information...
-            m_chargersStatusChangedCache.remove(charger);
+            if (m_chargersStatusChangedCache.remove(charger) > 0 || wasStale)
+                notifyChargerChanged(charger, traceId);
             return;
         }
 
         qint64 lastChangeTimestamp = entries.first().timestamp().toSecsSinceEpoch();
         qCDebug(dcEvDashExperience()) << "Last state change" << charger->name() << stateName << entries.first().timestamp().toString() << entries.first().values().first();
 
-        if (!m_chargersStatusChangedCache.contains(charger)) {
-            m_chargersStatusChangedCache.insert(charger, lastChangeTimestamp);
-            sendNotification("ChargerChanged", packCharger(charger));
-            return;
-        }
-
-        if (m_chargersStatusChangedCache.value(charger) != lastChangeTimestamp) {
+        if (!m_chargersStatusChangedCache.contains(charger) || m_chargersStatusChangedCache.value(charger) != lastChangeTimestamp || wasStale) {
             m_chargersStatusChangedCache[charger] = lastChangeTimestamp;
-            sendNotification("ChargerChanged", packCharger(charger));
-            return;
+            notifyChargerChanged(charger, traceId);
         }
     });
 }
 
-bool EvDashEngine::startWebSocketServer(quint16 port)
+void EvDashEngine::loadWarmStart()
 {
-    if (m_webSocketServer->isListening()) {
-        if (m_webSocketServer->serverPort() == port && port != 0)
-            return true;
+    QFile file(m_warmStartFileName);
+    if (!file.exists())
+        return;
 
-        m_webSocketServer->close();
+    if (!file.open(QFile::ReadOnly)) {
+        qCWarning(dcEvDashExperience()) << "Could not open warm start file" << m_warmStartFileName << file.errorString();
+        return;
     }
 
-    const bool listening = m_webSocketServer->listen(QHostAddress::AnyIPv4, port);
-    if (listening) {
-        qCDebug(dcEvDashExperience()) << "WebSocket server listening on" << m_webSocketServer->serverAddress() << m_webSocketServer->serverPort();
-    } else {
-        qCWarning(dcEvDashExperience()) << "Failed to start WebSocket server" << m_webSocketServer->errorString();
+    QCborParserError error;
+    const QCborMap warmStart = QCborValue::fromCbor(file.readAll(), &error).toMap();
+    if (error.error != QCborError::NoError || warmStart.value(QStringLiteral("version")).toInteger() != s_warmStartFormatVersion) {
+        qCWarning(dcEvDashExperience()) << "Ignoring invalid warm start file" << m_warmStartFileName;
+        return;
     }
 
-    emit webSocketListeningChanged(listening);
-    return listening;
-}
-
-void EvDashEngine::stopWebSocketServer()
-{
-    if (m_webSocketServer->isListening())
-        m_webSocketServer->close();
-
-    for (QWebSocket *client : qAsConst(m_clients)) {
-        if (client->state() == QAbstractSocket::ConnectedState)
-            client->close(QWebSocketProtocol::CloseCodeGoingAway, QStringLiteral("Server shutting down"));
+    const QCborMap statusUpdates = warmStart.value(QStringLiteral("statusUpdates")).toMap();
+    for (Thing *charger : qAsConst(m_chargers)) {
+        const QCborValue timestamp = statusUpdates.value(charger->id().toString(QUuid::WithoutBraces));
+        if (!timestamp.isInteger())
+            continue;
 
-        client->deleteLater();
+        m_chargersStatusChangedCache.insert(charger, timestamp.toInteger());
+        m_staleStatusUpdates.insert(charger->id());
+        verifyChargerStatusChanged(charger);
     }
 
-    m_clients.clear();
-    m_authenticatedClients.clear();
+    m_warmStartChargingInfos = warmStart.value(QStringLiteral("chargingInfos")).toArray().toVariantList();
+    m_chargingInfosStale = !m_warmStartChargingInfos.isEmpty() && !m_energyManagerClient->chargingInfosReceived();
+    if (!m_chargingInfosStale)
+        m_warmStartChargingInfos.clear();
+
+    const QDateTime savedAt = QDateTime::fromSecsSinceEpoch(warmStart.value(QStringLiteral("savedAt")).toInteger());
+    qCInfo(dcEvDashExperience()) << "Warm start from" << savedAt.toString(Qt::ISODate) << "restored" << m_staleStatusUpdates.count() << "status timestamps and"
+                                 << m_warmStartChargingInfos.count() << "charging infos";
 }
 
-void EvDashEngine::processTextMessage(QWebSocket *socket, const QString &message)
+void EvDashEngine::saveWarmStart()
 {
-    if (!socket)
+    if (m_warmStartFileName.isEmpty() || m_warmStartVersion == m_stateVersion)
         return;
 
-    QJsonParseError parseError;
-    const QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8(), &parseError);
+    QCborMap statusUpdates;
+    for (auto it = m_chargersStatusChangedCache.cbegin(); it != m_chargersStatusChangedCache.cend(); ++it)
+        statusUpdates.insert(it.key()->id().toString(QUuid::WithoutBraces), it.value());
 
-    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
-        qCWarning(dcEvDashExperience()) << "Invalid WebSocket payload" << parseError.errorString();
-        QJsonObject errorReply = createErrorResponse(QString(), QStringLiteral("invalidPayload"));
-        sendReply(socket, errorReply);
+    QCborMap warmStart;
+    warmStart.insert(QStringLiteral("version"), s_warmStartFormatVersion);
+    warmStart.insert(QStringLiteral("savedAt"), QDateTime::currentSecsSinceEpoch());
+    warmStart.insert(QStringLiteral("statusUpdates"), statusUpdates);
+    warmStart.insert(QStringLiteral("chargingInfos"), QCborArray::fromVariantList(chargingInfos()));
+
+    QDir().mkpath(QFileInfo(m_warmStartFileName).absolutePath());
+    QSaveFile file(m_warmStartFileName);
+    if (!file.open(QFile::WriteOnly) || file.write(warmStart.toCborValue().toCbor()) < 0 || !file.commit()) {
+        qCWarning(dcEvDashExperience()) << "Could not write warm start file" << m_warmStartFileName << file.errorString();
         return;
     }
 
-    qCDebug(dcEvDashExperience()) << "-->" << qUtf8Printable(doc.toJson(QJsonDocument::Compact));
+    m_warmStartVersion = m_stateVersion;
+}
+
+QVariantList EvDashEngine::chargingInfos() const
+{
+    if (m_chargingInfosStale || !m_energyManagerClient)
+        return m_warmStartChargingInfos;
+
+    return m_energyManagerClient->chargingInfos();
+}
+
+void EvDashEngine::rebuildChargerAssignments()
+{
+    m_chargerAssignments.clear();
+    foreach (const QVariant &chargingInfoVariant, chargingInfos())
+        updateChargerAssignment(chargingInfoVariant.toMap());
+}
+
+void EvDashEngine::updateChargerAssignment(const QVariantMap &chargingInfo)
+{
+    ChargerAssignment assignment;
+    assignment.assignedCarId = chargingInfo.value("assignedCarId").toUuid();
+    assignment.chargingMode = chargingInfo.value("chargingMode").toInt();
+    m_chargerAssignments.insert(chargingInfo.value("evChargerId").toUuid(), assignment);
+}
+
+bool EvDashEngine::startWebSocketServer(quint16 port)
+{
+    if (m_webSocketServer->isListening()) {
+        if (m_webSocketServer->serverPort() == port && port != 0)
+            return true;
+
+        stopWebSocketServer();
+    }
+
+    if (m_webSocketTlsError) {
+        qCWarning(dcEvDashExperience()) << "Failed to start WebSocket server: TLS is enabled but the certificate could not be loaded";
+        emit webSocketListeningChanged(false);
+        return false;
+    }
+
+    const bool listening = m_webSocketServer->listen(QHostAddress::AnyIPv4, port);
+    if (listening) {
+        qCDebug(dcEvDashExperience()) << "WebSocket server listening on" << m_webSocketServer->serverAddress() << m_webSocketServer->serverPort()
+                                      << (m_webSocketServer->sslEnabled() ? "(TLS)" : "");
+    } else {
+        qCWarning(dcEvDashExperience()) << "Failed to start WebSocket server" << m_webSocketServer->errorString();
+    }
+
+    emit webSocketListeningChanged(listening);
+    return listening;
+}
+
+bool EvDashEngine::loadSslConfiguration(QSslConfiguration *configuration) const
+{
+    // Use the certificate configured for nymead unless the dashboard has its own one
+    NymeaSettings nymeaSettings(NymeaSettings::SettingsRoleGlobal);
+    nymeaSettings.beginGroup("SSL");
+    QString certificateFileName = nymeaSettings.value("certificate").toString();
+    QString keyFileName = nymeaSettings.value("certificate-key").toString();
+    nymeaSettings.endGroup();
+
+    EvDashSettings settings;
+    settings.beginGroup("WebSocket");
+    certificateFileName = settings.value("certificate", certificateFileName).toString();
+    keyFileName = settings.value("certificateKey", keyFileName).toString();
+    settings.endGroup();
+
+    QFile certificateFile(certificateFileName);
+    if (!certificateFile.open(QFile::ReadOnly)) {
+        qCWarning(dcEvDashExperience()) << "Could not open TLS certificate" << certificateFileName << certificateFile.errorString();
+        return false;
+    }
+
+    const QList<QSslCertificate> certificateChain = QSslCertificate::fromData(certificateFile.readAll(), QSsl::Pem);
+    if (certificateChain.isEmpty()) {
+        qCWarning(dcEvDashExperience()) << "Could not load TLS certificate from" << certificateFileName;
+        return false;
+    }
+
+    QFile keyFile(keyFileName);
+    if (!keyFile.open(QFile::ReadOnly)) {
+        qCWarning(dcEvDashExperience()) << "Could not open TLS certificate key" << keyFileName << keyFile.errorString();
+        return false;
+    }
+
+    const QByteArray keyData = keyFile.readAll();
+    QSslKey key(keyData, QSsl::Rsa, QSsl::Pem);
+    if (key.isNull())
+        key = QSslKey(keyData, QSsl::Ec, QSsl::Pem);
+
+    if (key.isNull()) {
+        qCWarning(dcEvDashExperience()) << "Could not load TLS certificate key from" << keyFileName;
+        return false;
+    }
+
+    *configuration = QSslConfiguration::defaultConfiguration();
+    configuration->setLocalCertificateChain(certificateChain);
+    configuration->setPrivateKey(key);
+    configuration->setProtocol(QSsl::TlsV1_2OrLater);
+    configuration->setPeerVerifyMode(QSslSocket::VerifyNone);
+
+    // Allow clients to resume previous sessions
+    configuration->setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+    configuration->setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+    return true;
+}
+
+void EvDashEngine::stopWebSocketServer()
+{
+    if (!m_webSocketServer)
+        return;
+
+    m_webSocketServer->close();
+    m_clients.clear();
+    m_authenticatedClients.clear();
+    m_clientChargerFieldMasks.clear();
+    for (const RateClass &rateClass : qAsConst(m_rateClasses))
+        delete rateClass.timer;
+    m_rateClasses.clear();
+    m_clientRateClasses.clear();
+    m_pendingChargingSessionsRequests.clear();
+    m_pendingActionRequests.clear();
+    for (const PendingChargerActions &pendingActions : qAsConst(m_pendingChargerActions))
+        delete pendingActions.timeoutTimer;
+    m_pendingChargerActions.clear();
+    m_pendingBatches.clear();
+}
+
+void EvDashEngine::onClientConnected(quint64 clientId)
+{
+    m_clients.append(clientId);
+    m_authenticatedClients.insert(clientId, QString());
+    qCDebug(dcEvDashExperience()) << "WebSocket client connected" << m_webSocketServer->peerAddress(clientId).toString() << "Total clients:" << m_clients.count();
+
+    // Clients have to authenticate within the deadline, otherwise they get dropped
+    QTimer::singleShot(m_authenticationTimeout, this, [this, clientId]() {
+        if (!m_clients.contains(clientId) || !m_authenticatedClients.value(clientId).isEmpty())
+            return;
+
+        qCDebug(dcEvDashExperience()) << "WebSocket client" << m_webSocketServer->peerAddress(clientId).toString() << "did not authenticate in time. Closing connection.";
+        m_webSocketServer->closeClient(clientId, QWebSocketProtocol::CloseCodePolicyViolated, QStringLiteral("Authentication timeout"));
+    });
+}
+
+void EvDashEngine::onClientDisconnected(quint64 clientId)
+{
+    m_clients.removeAll(clientId);
+    m_authenticatedClients.remove(clientId);
+    m_clientChargerFieldMasks.remove(clientId);
+    setClientRateClass(clientId, 0);
+    for (auto it = m_pendingBatches.begin(); it != m_pendingBatches.end();) {
+        if (it->clientId == clientId) {
+            it = m_pendingBatches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    m_statistics->removeLabel("evdash_client_bytes_sent_total", QString::number(clientId));
+    qCDebug(dcEvDashExperience()) << "WebSocket client disconnected. Remaining clients:" << m_clients.count();
+}
+
+void EvDashEngine::onInvalidRequest(quint64 clientId, const QString &errorString)
+{
+    qCWarning(dcEvDashExperience()) << "Invalid WebSocket payload" << errorString;
+    QJsonObject errorReply = createErrorResponse(QString(), QStringLiteral("invalidPayload"));
+    sendReply(clientId, errorReply);
+}
+
+void EvDashEngine::processRequest(quint64 clientId, const QJsonObject &requestObject)
+{
+    if (!m_clients.contains(clientId))
+        return;
+
+    qCDebug(dcEvDashExperience()) << "-->" << qUtf8Printable(QJsonDocument(requestObject).toJson(QJsonDocument::Compact));
+
+    QElapsedTimer requestTimer;
+    requestTimer.start();
+    const qint64 traceStart = m_tracer->enabled() ? EvDashTracer::now() : 0;
 
-    const QJsonObject requestObject = doc.object();
     const QString requestId = requestObject.value(QStringLiteral("requestId")).toString();
     const QString action = requestObject.value(QStringLiteral("action")).toString();
 
     if (action.isEmpty()) {
         QJsonObject response = createErrorResponse(requestId, QStringLiteral("invalidAction"));
-        sendReply(socket, response);
+        sendReply(clientId, response);
         return;
     }
 
     const bool isAuthenticateAction = action.compare(QStringLiteral("authenticate"), Qt::CaseInsensitive) == 0;
-    if (!isAuthenticateAction) {
-        const QString token = m_authenticatedClients.value(socket);
+    // A batch may start with authenticate, its sub requests are checked one by one
+    const bool isBatchAction = action.compare(QStringLiteral("Batch"), Qt::CaseInsensitive) == 0;
+    if (!isAuthenticateAction && !isBatchAction) {
+        const QString token = m_authenticatedClients.value(clientId);
         if (token.isEmpty()) {
             QJsonObject response = createErrorResponse(requestId, QStringLiteral("unauthenticated"));
-            sendReply(socket, response);
-            socket->close(QWebSocketProtocol::CloseCodePolicyViolated, QStringLiteral("Authentication required"));
-            m_authenticatedClients.remove(socket);
+            sendReply(clientId, response);
+            m_webSocketServer->closeClient(clientId, QWebSocketProtocol::CloseCodePolicyViolated, QStringLiteral("Authentication required"));
+            m_authenticatedClients.remove(clientId);
             return;
         }
     }
 
-    QJsonObject response = handleApiRequest(socket, requestObject);
+    // The snapshot reply is spliced from the cached encoded snapshot, no encoding per client
+    if (action.compare(QStringLiteral("GetSnapshot"), Qt::CaseInsensitive) == 0) {
+        QString traceId;
+        if (m_tracer->enabled() && !requestId.isEmpty()) {
+            traceId = EvDashTracer::requestTraceId(clientId, requestId);
+            m_tracer->addSpan(traceId, QStringLiteral("dispatch"), traceStart, EvDashTracer::now(), {{"action", action}});
+        }
+
+        sendReplyData(clientId, createSnapshotReply(requestId), traceId);
+        m_statistics->observeDuration("evdash_request_duration_seconds", requestMetricLabel(action), requestTimer.nsecsElapsed());
+        if (!traceId.isEmpty())
+            m_tracer->addSpan(traceId, QStringLiteral("request"), traceStart, EvDashTracer::now(), {{"action", action}});
+        return;
+    }
+
+    QJsonObject response = handleApiRequest(clientId, requestObject);
+
+    const bool traced = m_tracer->enabled() && !requestId.isEmpty();
+    if (traced) {
+        const QString traceId = EvDashTracer::requestTraceId(clientId, requestId);
+        m_tracer->addSpan(traceId, QStringLiteral("dispatch"), traceStart, EvDashTracer::now(), {{"action", action}});
+
+        // Asynchronous requests record the request span once the backend replied
+        PendingRequest *pendingRequest = findPendingRequest(clientId, requestId);
+        if (response.isEmpty() && pendingRequest)
+            pendingRequest->traceStart = traceStart;
+    }
+
     if (!response.isEmpty()) {
-        sendReply(socket, response);
+        sendReply(clientId, response);
+        m_statistics->observeDuration("evdash_request_duration_seconds", requestMetricLabel(action), requestTimer.nsecsElapsed());
+        if (traced)
+            m_tracer->addSpan(EvDashTracer::requestTraceId(clientId, requestId), QStringLiteral("request"), traceStart, EvDashTracer::now(), {{"action", action}});
 
         if (isAuthenticateAction && !response.value(QStringLiteral("success")).toBool()) {
-            socket->close(QWebSocketProtocol::CloseCodePolicyViolated, QStringLiteral("Authentication failed"));
-            m_authenticatedClients.remove(socket);
+            m_webSocketServer->closeClient(clientId, QWebSocketProtocol::CloseCodePolicyViolated, QStringLiteral("Authentication failed"));
+            m_authenticatedClients.remove(clientId);
         }
     }
+
+    if (isBatchAction && m_authenticatedClients.value(clientId).isEmpty()) {
+        m_webSocketServer->closeClient(clientId, QWebSocketProtocol::CloseCodePolicyViolated, QStringLiteral("Authentication required"));
+        m_authenticatedClients.remove(clientId);
+    }
 }
 
-QJsonObject EvDashEngine::handleApiRequest(QWebSocket *socket, const QJsonObject &request)
+QJsonObject EvDashEngine::handleApiRequest(quint64 clientId, const QJsonObject &request)
 {
     qCDebug(dcEvDashExperience()) << "Handle API request" << request;
 
@@ -397,16 +1223,32 @@ QJsonObject EvDashEngine::handleApiRequest(QWebSocket *socket, const QJsonObject
             return createErrorResponse(requestId, QStringLiteral("missingToken"));
 
         if (!m_webServerResource || !m_webServerResource->validateToken(token)) {
-            m_authenticatedClients.remove(socket);
+            m_authenticatedClients.remove(clientId);
             return createErrorResponse(requestId, QStringLiteral("unauthorized"));
         }
 
-        m_authenticatedClients.insert(socket, token);
-
         QJsonObject responsePayload{{QStringLiteral("authenticated"), true}, {QStringLiteral("timestamp"), QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs)}};
+
+        // Resuming before the client joins the recipients keeps replayed frames ahead of live ones.
+        // A client which is authenticated already received the notifications live.
+        const QJsonValue resumeValue = payload.value(QStringLiteral("resume"));
+        if (resumeValue.isObject() && m_authenticatedClients.value(clientId).isEmpty()) {
+            const QJsonObject resumePayload = resume(clientId, resumeValue.toObject());
+            for (auto it = resumePayload.constBegin(); it != resumePayload.constEnd(); ++it)
+                responsePayload.insert(it.key(), it.value());
+        }
+
+        m_authenticatedClients.insert(clientId, token);
+
+        responsePayload.insert(QStringLiteral("epoch"), m_notificationEpoch);
+        responsePayload.insert(QStringLiteral("seq"), static_cast<qint64>(m_notificationSequence));
         return createSuccessResponse(requestId, responsePayload);
     }
 
+
+    if (action.compare(QStringLiteral("Batch"), Qt::CaseInsensitive) == 0)
+        return handleBatch(clientId, requestId, request.value(QStringLiteral("payload")).toObject());
+
     if (action.compare(QStringLiteral("ping"), Qt::CaseInsensitive) == 0) {
         QJsonObject payload;
         payload.insert(QStringLiteral("timestamp"), QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs));
@@ -418,6 +1260,20 @@ QJsonObject EvDashEngine::handleApiRequest(QWebSocket *socket, const QJsonObject
         return createSuccessResponse(requestId, payload);
     }
 
+    if (action.compare(QStringLiteral("Subscribe"), Qt::CaseInsensitive) == 0)
+        return subscribe(clientId, requestId, request.value(QStringLiteral("payload")).toObject());
+
+    if (action.compare(QStringLiteral("ExecuteChargerActions"), Qt::CaseInsensitive) == 0)
+        return executeChargerActions(clientId, requestId, request.value(QStringLiteral("payload")).toObject());
+
+    if (action.compare(QStringLiteral("GetSnapshot"), Qt::CaseInsensitive) == 0) {
+        updateSnapshot();
+        return createSuccessResponse(requestId, m_snapshot);
+    }
+
+    if (action.compare(QStringLiteral("GetGroups"), Qt::CaseInsensitive) == 0)
+        return createSuccessResponse(requestId, QJsonObject{{QStringLiteral("groups"), packGroups()}});
+
     if (action.compare(QStringLiteral("GetChargers"), Qt::CaseInsensitive) == 0) {
         QJsonObject payload;
         QJsonArray chargerList;
@@ -461,39 +1317,751 @@ QJsonObject EvDashEngine::handleApiRequest(QWebSocket *socket, const QJsonObject
                 carThingIds = carThingIdsForCharger(chargerId);
         }
 
-        m_pendingChargingSessionsRequests.insert(requestId, QPointer<QWebSocket>(socket));
-        m_chargingSessionsClient->getSessions(carThingIds);
+        // Optional range of session end timestamps, 0 means unbounded
+        const qint64 startTimestamp = payload.value(QStringLiteral("startTimestamp")).toVariant().toLongLong();
+        const qint64 endTimestamp = payload.value(QStringLiteral("endTimestamp")).toVariant().toLongLong();
+        if (startTimestamp < 0 || endTimestamp < 0)
+            return createErrorResponse(requestId, QStringLiteral("invalidTimestamp"));
+
+        if (m_sessionStore && m_sessionStoreSynced) {
+            requestSessionSync();
+            return createSuccessResponse(requestId, createSessionsPayload(m_sessionStore->sessions(carThingIds, startTimestamp, endTimestamp)));
+        }
+
+        PendingRequest pendingRequest;
+        pendingRequest.clientId = clientId;
+        pendingRequest.action = requestMetricLabel(action);
+        pendingRequest.timer.start();
+        pendingRequest.carThingIds = carThingIds;
+        pendingRequest.startTimestamp = startTimestamp;
+        pendingRequest.endTimestamp = endTimestamp;
+        if (m_tracer->enabled())
+            pendingRequest.backendStart = EvDashTracer::now();
+        m_pendingChargingSessionsRequests.insert(requestId, pendingRequest);
+
+        // Without a store every request fetches the complete history
+        if (m_sessionStore) {
+            requestSessionSync();
+        } else {
+            m_chargingSessionsClient->getSessions(carThingIds);
+        }
         return {};
     }
 
     return createErrorResponse(requestId, QStringLiteral("unknownAction"));
 }
 
-void EvDashEngine::sendReply(QWebSocket *socket, QJsonObject response) const
+QJsonObject EvDashEngine::handleBatch(quint64 clientId, const QString &requestId, const QJsonObject &payload)
+{
+    const QJsonValue requestsValue = payload.value(QStringLiteral("requests"));
+    if (!requestsValue.isArray())
+        return createErrorResponse(requestId, QStringLiteral("invalidBatch"));
+
+    const QJsonArray requests = requestsValue.toArray();
+    if (requests.isEmpty())
+        return createErrorResponse(requestId, QStringLiteral("invalidBatch"));
+
+    if (requests.count() > m_maxBatchSize)
+        return createErrorResponse(requestId, QStringLiteral("batchTooLarge"));
+
+    // Sub requests run in order. Asynchronous ones get an internal request id so
+    // their replies end up in this batch, they complete concurrently.
+    const QString batchKey = QUuid::createUuid().toString(QUuid::WithoutBraces);
+
+    PendingBatch batch;
+    batch.clientId = clientId;
+    batch.requestId = requestId;
+    batch.timer.start();
+
+    for (int i = 0; i < requests.count(); i++) {
+        const QJsonObject subRequest = requests.at(i).toObject();
+        const QString subRequestId = subRequest.value(QStringLiteral("requestId")).toString();
+        const QString subAction = subRequest.value(QStringLiteral("action")).toString();
+        batch.requestIds.append(subRequestId);
+
+        if (subAction.isEmpty() || subAction.compare(QStringLiteral("Batch"), Qt::CaseInsensitive) == 0) {
+            batch.responses.append(createErrorResponse(subRequestId, QStringLiteral("invalidAction")));
+            continue;
+        }
+
+        const bool isAuthenticateAction = subAction.compare(QStringLiteral("authenticate"), Qt::CaseInsensitive) == 0;
+        if (!isAuthenticateAction && m_authenticatedClients.value(clientId).isEmpty()) {
+            batch.responses.append(createErrorResponse(subRequestId, QStringLiteral("unauthenticated")));
+            continue;
+        }
+
+        QElapsedTimer requestTimer;
+        requestTimer.start();
+
+        const QString internalRequestId = QStringLiteral("%1#%2").arg(batchKey).arg(i);
+        QJsonObject internalRequest = subRequest;
+        internalRequest.insert(QStringLiteral("requestId"), internalRequestId);
+
+        QJsonObject response = handleApiRequest(clientId, internalRequest);
+        if (response.isEmpty()) {
+            // Without a pending request the slot stays empty and is answered with an error
+            PendingRequest *pendingRequest = findPendingRequest(clientId, internalRequestId);
+            if (pendingRequest) {
+                pendingRequest->batchKey = batchKey;
+                pendingRequest->batchIndex = i;
+                batch.outstanding++;
+            }
+
+            batch.responses.append(QJsonObject());
+            continue;
+        }
+
+        m_statistics->observeDuration("evdash_request_duration_seconds", requestMetricLabel(subAction), requestTimer.nsecsElapsed());
+        batch.responses.append(response);
+    }
+
+    if (batch.outstanding > 0) {
+        m_pendingBatches.insert(batchKey, batch);
+        return {};
+    }
+
+    return createBatchResponse(batch);
+}
+
+void EvDashEngine::finishBatchRequest(const QString &batchKey, int index, const QJsonObject &response)
+{
+    auto it = m_pendingBatches.find(batchKey);
+    if (it == m_pendingBatches.end())
+        return;
+
+    it->responses[index] = response;
+    if (--it->outstanding > 0)
+        return;
+
+    const PendingBatch batch = m_pendingBatches.take(batchKey);
+    if (!m_clients.contains(batch.clientId))
+        return;
+
+    sendReply(batch.clientId, createBatchResponse(batch));
+    m_statistics->observeDuration("evdash_request_duration_seconds", QStringLiteral("Batch"), batch.timer.nsecsElapsed());
+}
+
+QJsonObject EvDashEngine::createBatchResponse(const PendingBatch &batch) const
+{
+    // Replace the internal request ids with the ones of the client
+    QJsonArray responses;
+    for (int i = 0; i < batch.responses.count(); i++) {
+        QJsonObject response = batch.responses.at(i);
+        if (response.isEmpty())
+            response = createErrorResponse(QString(), QStringLiteral("requestFailed"));
+
+        if (batch.requestIds.at(i).isEmpty()) {
+            response.remove(QStringLiteral("requestId"));
+        } else {
+            response.insert(QStringLiteral("requestId"), batch.requestIds.at(i));
+        }
+
+        responses.append(response);
+    }
+
+    return createSuccessResponse(batch.requestId, QJsonObject{{QStringLiteral("responses"), responses}});
+}
+
+void EvDashEngine::sendReply(quint64 clientId, QJsonObject response) const
+{
+    QElapsedTimer serializeTimer;
+    serializeTimer.start();
+    const qint64 traceStart = m_tracer->enabled() ? EvDashTracer::now() : 0;
+    const QByteArray replyData = QJsonDocument(response).toJson(QJsonDocument::Compact);
+    m_statistics->observeDuration("evdash_serialize_duration_seconds", QStringLiteral("reply"), serializeTimer.nsecsElapsed());
+
+    QString traceId;
+    const QString requestId = response.value(QStringLiteral("requestId")).toString();
+    if (m_tracer->enabled() && !requestId.isEmpty()) {
+        traceId = EvDashTracer::requestTraceId(clientId, requestId);
+        m_tracer->addSpan(traceId, QStringLiteral("encode"), traceStart, EvDashTracer::now(), {{"bytes", replyData.size()}});
+    }
+
+    sendReplyData(clientId, replyData, traceId);
+}
+
+void EvDashEngine::sendReplyData(quint64 clientId, const QByteArray &replyData, const QString &traceId) const
+{
+    qCDebug(dcEvDashExperience()) << "<--" << qUtf8Printable(replyData);
+    m_webSocketServer->sendTextMessage(clientId, replyData, traceId);
+
+    m_statistics->incrementCounter("evdash_bytes_sent_total", QString(), replyData.size());
+    m_statistics->incrementCounter("evdash_client_bytes_sent_total", QString::number(clientId), replyData.size());
+}
+
+EvDashEngine::PendingRequest *EvDashEngine::findPendingRequest(quint64 clientId, const QString &requestId)
+{
+    auto it = m_pendingChargingSessionsRequests.find(requestId);
+    if (it != m_pendingChargingSessionsRequests.end())
+        return &it.value();
+
+    auto actionIt = m_pendingActionRequests.find(chargerActionsKey(clientId, requestId));
+    if (actionIt != m_pendingActionRequests.end())
+        return &actionIt.value();
+
+    return nullptr;
+}
+
+void EvDashEngine::finishPendingRequest(const QString &requestId, const QJsonObject &response)
+{
+    finishPendingRequest(requestId, m_pendingChargingSessionsRequests.take(requestId), response);
+}
+
+void EvDashEngine::finishPendingRequest(const QString &requestId, const PendingRequest &pendingRequest, const QJsonObject &response)
+{
+    if (!pendingRequest.batchKey.isEmpty()) {
+        m_statistics->observeDuration("evdash_request_duration_seconds", pendingRequest.action, pendingRequest.timer.nsecsElapsed());
+        finishBatchRequest(pendingRequest.batchKey, pendingRequest.batchIndex, response);
+        return;
+    }
+
+    if (!m_clients.contains(pendingRequest.clientId))
+        return;
+
+    const bool traced = m_tracer->enabled() && pendingRequest.traceStart > 0;
+    const QString traceId = EvDashTracer::requestTraceId(pendingRequest.clientId, requestId);
+    if (traced)
+        m_tracer->addSpan(traceId, QStringLiteral("backend"), pendingRequest.backendStart, EvDashTracer::now(), {{"success", response.value(QStringLiteral("success")).toBool()}});
+
+    sendReply(pendingRequest.clientId, response);
+    m_statistics->observeDuration("evdash_request_duration_seconds", pendingRequest.action, pendingRequest.timer.nsecsElapsed());
+    if (traced)
+        m_tracer->addSpan(traceId, QStringLiteral("request"), pendingRequest.traceStart, EvDashTracer::now(), {{"action", pendingRequest.action}});
+}
+
+void EvDashEngine::sendNotification(const QString &notification, QJsonObject payload, const QString &traceId, quint32 changedFields, const EvDashChargerFields::Values &fieldValues)
+{
+    if (!m_webSocketServer)
+        return;
+
+    // Encode once and hand the same frame to all authenticated clients
+    QList<quint64> recipients;
+    for (quint64 clientId : qAsConst(m_clients)) {
+        if (!m_authenticatedClients.value(clientId).isEmpty())
+            recipients.append(clientId);
+    }
+
+    // Without recipients the notification is still logged, a dropped client may resume later
+    if (recipients.isEmpty() && m_replayLogSize == 0)
+        return;
+
+    const quint64 sequence = ++m_notificationSequence;
+
+    // A trace id passed by the caller doubles as requestId, so the trace can be matched with what clients received
+    const QString requestId = traceId.isEmpty() ? QUuid::createUuid().toString(QUuid::WithoutBraces) : traceId;
+
+    QJsonObject notificationObject;
+    notificationObject.insert(QStringLiteral("requestId"), requestId);
+    notificationObject.insert("event", notification);
+    notificationObject.insert("seq", static_cast<qint64>(sequence));
+    notificationObject.insert("timestamp", QDateTime::currentMSecsSinceEpoch());
+    notificationObject.insert("payload", payload);
+
+    QElapsedTimer serializeTimer;
+    serializeTimer.start();
+    const qint64 traceStart = m_tracer->enabled() ? EvDashTracer::now() : 0;
+    const QByteArray notificationData = QJsonDocument(notificationObject).toJson(QJsonDocument::Compact);
+    m_statistics->observeDuration("evdash_serialize_duration_seconds", QStringLiteral("notification"), serializeTimer.nsecsElapsed());
+
+    QString frameTraceId;
+    if (m_tracer->enabled()) {
+        frameTraceId = requestId;
+        m_tracer->addSpan(frameTraceId, QStringLiteral("encode"), traceStart, EvDashTracer::now(), {{"event", notification}, {"clients", recipients.count()}, {"bytes", notificationData.size()}});
+    }
+
+    appendToReplayLog(sequence, notificationData);
+
+    // Rate limited clients get the latest change of a charger once their class flushes.
+    // Only charger notifications come with field values.
+    if (!m_rateClasses.isEmpty() && !fieldValues.isEmpty()) {
+        const QString chargerId = fieldValues.at(EvDashChargerFields::FieldId).toString();
+        const bool changed = notification == QStringLiteral("ChargerChanged");
+        for (auto it = m_rateClasses.begin(); it != m_rateClasses.end(); ++it) {
+            if (!changed) {
+                // Added and removed chargers are delivered right away, older changes are obsolete then
+                it->pending.remove(chargerId);
+                continue;
+            }
+
+            PendingNotification &pending = it->pending[chargerId];
+            pending.notificationObject = notificationObject;
+            pending.notificationData = notificationData;
+            pending.fieldValues = fieldValues;
+            pending.changedFields |= changedFields;
+        }
+
+        if (changed) {
+            for (auto it = recipients.begin(); it != recipients.end();) {
+                if (m_clientRateClasses.contains(*it)) {
+                    it = recipients.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    deliverNotification(notification, notificationObject, notificationData, recipients, changedFields, fieldValues, frameTraceId);
+}
+
+void EvDashEngine::deliverNotification(const QString &notification, QJsonObject notificationObject, const QByteArray &notificationData, QList<quint64> recipients, quint32 changedFields, const EvDashChargerFields::Values &fieldValues, const QString &traceId)
+{
+    if (recipients.isEmpty())
+        return;
+
+    // Clients with a field mask get the charger reduced to their fields, encoded once per distinct mask.
+    // Clients none of whose fields changed are skipped, the id alone tells them nothing.
+    QHash<quint32, QList<quint64>> projectedRecipients;
+    if (!m_clientChargerFieldMasks.isEmpty() && !fieldValues.isEmpty()) {
+        const quint32 relevantFields = changedFields & ~EvDashChargerFields::derivedFieldBit(EvDashChargerFields::FieldId);
+        for (auto it = recipients.begin(); it != recipients.end();) {
+            auto mask = m_clientChargerFieldMasks.constFind(*it);
+            if (mask == m_clientChargerFieldMasks.constEnd()) {
+                ++it;
+                continue;
+            }
+
+            if (mask.value() & relevantFields)
+                projectedRecipients[mask.value()].append(*it);
+
+            it = recipients.erase(it);
+        }
+    }
+
+    for (auto it = projectedRecipients.cbegin(); it != projectedRecipients.cend(); ++it) {
+        notificationObject.insert("payload", EvDashChargerFields::toJson(fieldValues, it.key()));
+        sendNotificationData(notification, it.value(), QJsonDocument(notificationObject).toJson(QJsonDocument::Compact), traceId);
+    }
+
+    if (!recipients.isEmpty())
+        sendNotificationData(notification, recipients, notificationData, traceId);
+}
+
+void EvDashEngine::sendNotificationData(const QString &notification, const QList<quint64> &recipients, const QByteArray &notificationData, const QString &traceId)
+{
+    qCDebug(dcEvDashExperience()) << "<--" << qUtf8Printable(notificationData);
+    m_webSocketServer->sendTextMessage(recipients, notificationData, traceId);
+
+    m_statistics->incrementCounter("evdash_notifications_sent_total", notification, recipients.count());
+    m_statistics->incrementCounter("evdash_bytes_sent_total", QString(), static_cast<double>(notificationData.size()) * recipients.count());
+    for (quint64 clientId : recipients)
+        m_statistics->incrementCounter("evdash_client_bytes_sent_total", QString::number(clientId), notificationData.size());
+}
+
+QJsonObject EvDashEngine::subscribe(quint64 clientId, const QString &requestId, const QJsonObject &payload)
+{
+    const QJsonArray fields = payload.value(QStringLiteral("fields")).toArray();
+
+    // Without a maxRate the client gets every change
+    int interval = 0;
+    const QJsonValue maxRateValue = payload.value(QStringLiteral("maxRate"));
+    if (!maxRateValue.isUndefined() && !maxRateValue.isNull()) {
+        if (!maxRateValue.isDouble() || maxRateValue.toDouble() < 0)
+            return createErrorResponse(requestId, QStringLiteral("invalidMaxRate"));
+
+        // Intervals are rounded to 100 ms steps, so similar rates share one class.
+        // Clamped before rounding, tiny rates would overflow the int otherwise.
+        if (maxRateValue.toDouble() > 0) {
+            const double exactInterval = qBound<double>(s_minRateClassInterval, 1000.0 / maxRateValue.toDouble(), s_maxRateClassInterval);
+            interval = qRound(exactInterval / 100) * 100;
+        }
+    }
+
+    // Without fields the client gets complete chargers again
+    quint32 mask = EvDashChargerFields::s_allFields;
+    if (!fields.isEmpty()) {
+        // The id is always part of the payload, clients need it to match the charger
+        mask = EvDashChargerFields::derivedFieldBit(EvDashChargerFields::FieldId);
+        for (const QJsonValue &field : fields) {
+            const int bit = EvDashChargerFields::fieldBit(field.toString());
+            if (bit < 0)
+                return createErrorResponse(requestId, QStringLiteral("unknownField"));
+
+            mask |= 1u << bit;
+        }
+    }
+
+    if (fields.isEmpty()) {
+        m_clientChargerFieldMasks.remove(clientId);
+    } else {
+        m_clientChargerFieldMasks.insert(clientId, mask);
+    }
+
+    setClientRateClass(clientId, interval);
+
+    QJsonArray subscribedFields;
+    for (int bit = 0; bit < EvDashChargerFields::s_fieldCount; bit++) {
+        if (mask & (1u << bit))
+            subscribedFields.append(EvDashChargerFields::fieldNames().at(bit));
+    }
+
+    QJsonObject responsePayload;
+    responsePayload.insert(QStringLiteral("fields"), subscribedFields);
+    responsePayload.insert(QStringLiteral("maxRate"), interval > 0 ? 1000.0 / interval : 0);
+    return createSuccessResponse(requestId, responsePayload);
+}
+
+void EvDashEngine::setClientRateClass(quint64 clientId, int interval)
+{
+    const int previousInterval = m_clientRateClasses.value(clientId);
+    if (previousInterval == interval)
+        return;
+
+    if (previousInterval > 0) {
+        m_clientRateClasses.remove(clientId);
+        RateClass &rateClass = m_rateClasses[previousInterval];
+        rateClass.clients.removeAll(clientId);
+        if (rateClass.clients.isEmpty()) {
+            delete rateClass.timer;
+            m_rateClasses.remove(previousInterval);
+        }
+    }
+
+    if (interval <= 0)
+        return;
+
+    m_clientRateClasses.insert(clientId, interval);
+    RateClass &rateClass = m_rateClasses[interval];
+    if (!rateClass.timer) {
+        rateClass.timer = new QTimer(this);
+        rateClass.timer->setInterval(interval);
+        connect(rateClass.timer, &QTimer::timeout, this, [this, interval]() { flushRateClass(interval); });
+        rateClass.timer->start();
+    }
+
+    rateClass.clients.append(clientId);
+}
+
+void EvDashEngine::flushRateClass(int interval)
 {
-    if (!socket)
+    auto rateClass = m_rateClasses.find(interval);
+    if (rateClass == m_rateClasses.end() || rateClass->pending.isEmpty())
         return;
 
-    const QJsonDocument replyDoc(response);
-    qCDebug(dcEvDashExperience()) << "<--" << qUtf8Printable(replyDoc.toJson(QJsonDocument::Compact));
-    socket->sendTextMessage(QString::fromUtf8(replyDoc.toJson(QJsonDocument::Compact)));
+    const QHash<QString, PendingNotification> pending = rateClass->pending;
+    rateClass->pending.clear();
+
+    const QList<quint64> recipients = rateClass->clients;
+    for (const PendingNotification &notification : pending)
+        deliverNotification(QStringLiteral("ChargerChanged"), notification.notificationObject, notification.notificationData, recipients, notification.changedFields, notification.fieldValues, QString());
 }
 
-void EvDashEngine::sendNotification(const QString &notification, QJsonObject payload) const
+QJsonObject EvDashEngine::executeChargerActions(quint64 clientId, const QString &requestId, const QJsonObject &payload)
 {
-    // Send to all active clients
-    for (QWebSocket *client : qAsConst(m_clients)) {
-        if (m_authenticatedClients.value(client).isEmpty())
+    if (!m_chargerActionsEnabled)
+        return createErrorResponse(requestId, QStringLiteral("chargerActionsDisabled"));
+
+    const QJsonArray actions = payload.value(QStringLiteral("actions")).toArray();
+    if (actions.isEmpty())
+        return createErrorResponse(requestId, QStringLiteral("invalidActions"));
+
+    if (actions.count() > m_maxChargerActions)
+        return createErrorResponse(requestId, QStringLiteral("tooManyActions"));
+
+    // The reply is matched by the request id, it has to be unique among the pending requests of the client
+    if (requestId.isEmpty())
+        return createErrorResponse(requestId, QStringLiteral("missingRequestId"));
+
+    const QString pendingKey = chargerActionsKey(clientId, requestId);
+    if (m_pendingActionRequests.contains(pendingKey))
+        return createErrorResponse(requestId, QStringLiteral("duplicateRequestId"));
+
+    // Invalid entries fail right away, the others are dispatched below
+    PendingChargerActions pendingActions;
+    pendingActions.clientId = clientId;
+    pendingActions.requestId = requestId;
+    QList<QPair<int, Action>> dispatchedActions;
+    for (int i = 0; i < actions.count(); i++) {
+        const QJsonObject actionObject = actions.at(i).toObject();
+        const QString chargerId = actionObject.value(QStringLiteral("chargerId")).toString();
+        const QString actionName = actionObject.value(QStringLiteral("action")).toString();
+
+        QJsonObject result;
+        result.insert(QStringLiteral("chargerId"), chargerId);
+        result.insert(QStringLiteral("action"), actionName);
+
+        QString error;
+        Thing *charger = m_thingManager->findConfiguredThing(QUuid::fromString(chargerId));
+        ActionType actionType;
+        if (!charger || !m_chargers.contains(charger)) {
+            error = QStringLiteral("chargerNotFound");
+        } else {
+            actionType = charger->thingClass().actionTypes().findByName(actionName);
+            if (actionType.id().isNull())
+                error = QStringLiteral("actionNotFound");
+        }
+
+        ParamList params;
+        const QJsonObject paramsObject = actionObject.value(QStringLiteral("params")).toObject();
+        for (auto it = paramsObject.constBegin(); error.isEmpty() && it != paramsObject.constEnd(); ++it) {
+            const ParamType paramType = actionType.paramTypes().findByName(it.key());
+            if (paramType.id().isNull()) {
+                error = QStringLiteral("invalidParameter");
+                break;
+            }
+
+            params.append(Param(paramType.id(), it.value().toVariant()));
+        }
+
+        if (!error.isEmpty()) {
+            result.insert(QStringLiteral("success"), false);
+            result.insert(QStringLiteral("status"), error);
+            pendingActions.results.append(result);
             continue;
+        }
 
-        QJsonObject notificationObject;
-        notificationObject.insert(QStringLiteral("requestId"), QUuid::createUuid().toString(QUuid::WithoutBraces));
-        notificationObject.insert("event", notification);
-        notificationObject.insert("payload", payload);
-        const QJsonDocument notificationDoc(notificationObject);
-        qCDebug(dcEvDashExperience()) << "<--" << qUtf8Printable(notificationDoc.toJson(QJsonDocument::Compact));
-        client->sendTextMessage(QString::fromUtf8(notificationDoc.toJson(QJsonDocument::Compact)));
+        Action action(actionType.id(), charger->id());
+        action.setParams(params);
+        dispatchedActions.append(qMakePair(i, action));
+        pendingActions.results.append(result);
+    }
+
+    if (dispatchedActions.isEmpty())
+        return createSuccessResponse(requestId, QJsonObject{{QStringLiteral("results"), pendingActions.results}, {QStringLiteral("succeeded"), 0}, {QStringLiteral("failed"), actions.count()}});
+
+    qCDebug(dcEvDashExperience()) << "Executing" << dispatchedActions.count() << "charger actions for client" << clientId;
+
+    // Actions still running at the deadline are reported as timed out
+    const quint64 actionsId = ++m_chargerActionsSequence;
+    pendingActions.outstanding = dispatchedActions.count();
+    pendingActions.timeoutTimer = new QTimer(this);
+    pendingActions.timeoutTimer->setSingleShot(true);
+    connect(pendingActions.timeoutTimer, &QTimer::timeout, this, [this, actionsId]() { finishChargerActions(actionsId); });
+    pendingActions.timeoutTimer->start(m_chargerActionsTimeout);
+    m_pendingChargerActions.insert(actionsId, pendingActions);
+
+    PendingRequest pendingRequest;
+    pendingRequest.clientId = clientId;
+    pendingRequest.action = requestMetricLabel(QStringLiteral("ExecuteChargerActions"));
+    pendingRequest.timer.start();
+    if (m_tracer->enabled())
+        pendingRequest.backendStart = EvDashTracer::now();
+    m_pendingActionRequests.insert(pendingKey, pendingRequest);
+
+    const QMetaEnum thingErrorEnum = QMetaEnum::fromType<Thing::ThingError>();
+    for (const QPair<int, Action> &dispatchedAction : qAsConst(dispatchedActions)) {
+        const int index = dispatchedAction.first;
+        ThingActionInfo *info = m_thingManager->executeAction(dispatchedAction.second);
+        connect(info, &ThingActionInfo::finished, this, [this, actionsId, index, info, thingErrorEnum]() {
+            finishChargerAction(actionsId, index, QString::fromLatin1(thingErrorEnum.valueToKey(info->status())), info->displayMessage());
+        });
     }
+
+    return {};
+}
+
+void EvDashEngine::finishChargerAction(quint64 actionsId, int index, const QString &status, const QString &displayMessage)
+{
+    // Results after the timeout are dropped, the reply is gone already
+    auto it = m_pendingChargerActions.find(actionsId);
+    if (it == m_pendingChargerActions.end())
+        return;
+
+    QJsonObject result = it->results.at(index).toObject();
+    result.insert(QStringLiteral("success"), status == QStringLiteral("ThingErrorNoError"));
+    result.insert(QStringLiteral("status"), status);
+    if (!displayMessage.isEmpty())
+        result.insert(QStringLiteral("displayMessage"), displayMessage);
+    it->results.replace(index, result);
+
+    if (--it->outstanding == 0)
+        finishChargerActions(actionsId);
+}
+
+void EvDashEngine::finishChargerActions(quint64 actionsId)
+{
+    auto it = m_pendingChargerActions.find(actionsId);
+    if (it == m_pendingChargerActions.end())
+        return;
+
+    // Called from the timeout as well, so the timer cannot be deleted right away
+    PendingChargerActions pendingActions = it.value();
+    m_pendingChargerActions.erase(it);
+    if (pendingActions.timeoutTimer)
+        pendingActions.timeoutTimer->deleteLater();
+
+    int succeeded = 0;
+    for (int i = 0; i < pendingActions.results.count(); i++) {
+        QJsonObject result = pendingActions.results.at(i).toObject();
+        if (!result.contains(QStringLiteral("status"))) {
+            result.insert(QStringLiteral("success"), false);
+            result.insert(QStringLiteral("status"), QStringLiteral("ThingErrorTimeout"));
+            pendingActions.results.replace(i, result);
+        }
+
+        if (result.value(QStringLiteral("success")).toBool())
+            succeeded++;
+    }
+
+    QJsonObject payload;
+    payload.insert(QStringLiteral("results"), pendingActions.results);
+    payload.insert(QStringLiteral("succeeded"), succeeded);
+    payload.insert(QStringLiteral("failed"), pendingActions.results.count() - succeeded);
+    const PendingRequest pendingRequest = m_pendingActionRequests.take(chargerActionsKey(pendingActions.clientId, pendingActions.requestId));
+    finishPendingRequest(pendingActions.requestId, pendingRequest, createSuccessResponse(pendingActions.requestId, payload));
+}
+
+void EvDashEngine::appendToReplayLog(quint64 sequence, const QByteArray &frame)
+{
+    if (m_replayLogSize == 0)
+        return;
+
+    ReplayEntry entry;
+    entry.sequence = sequence;
+    entry.frame = frame;
+    m_replayLog.enqueue(entry);
+    m_replayLogBytes += frame.size();
+
+    while (!m_replayLog.isEmpty() && (m_replayLog.count() > m_replayLogSize || m_replayLogBytes > m_replayLogMaxBytes))
+        m_replayLogBytes -= m_replayLog.dequeue().frame.size();
+}
+
+QJsonObject EvDashEngine::resume(quint64 clientId, const QJsonObject &resumeObject)
+{
+    QJsonObject responsePayload;
+
+    const QJsonValue lastSeqValue = resumeObject.value(QStringLiteral("lastSeq"));
+    const bool validLastSeq = lastSeqValue.isDouble() && lastSeqValue.toDouble() >= 0;
+    const quint64 lastSeq = validLastSeq ? static_cast<quint64>(lastSeqValue.toDouble()) : 0;
+
+    // The client missed everything after lastSeq. Replay only if the log still covers that gap
+    // and the sequence numbers are from this engine instance.
+    const bool sameEpoch = resumeObject.value(QStringLiteral("epoch")).toString() == m_notificationEpoch;
+    const bool covered = lastSeq == m_notificationSequence || (!m_replayLog.isEmpty() && m_replayLog.head().sequence <= lastSeq + 1);
+    if (!validLastSeq || !sameEpoch || lastSeq > m_notificationSequence || !covered) {
+        // Fall back to the full state, the client reloads from this snapshot
+        updateSnapshot();
+        responsePayload.insert(QStringLiteral("resumed"), false);
+        responsePayload.insert(QStringLiteral("chargers"), m_snapshot.value(QStringLiteral("chargers")));
+        responsePayload.insert(QStringLiteral("cars"), m_snapshot.value(QStringLiteral("cars")));
+        m_statistics->incrementCounter("evdash_resume_requests_total", QStringLiteral("snapshot"));
+        return responsePayload;
+    }
+
+    // Missed frames are queued before the reply and before any live notification, in their original order
+    int replayed = 0;
+    qint64 replayedBytes = 0;
+    for (const ReplayEntry &entry : qAsConst(m_replayLog)) {
+        if (entry.sequence <= lastSeq)
+            continue;
+
+        m_webSocketServer->sendTextMessage(clientId, entry.frame);
+        replayedBytes += entry.frame.size();
+        replayed++;
+    }
+
+    m_statistics->incrementCounter("evdash_bytes_sent_total", QString(), replayedBytes);
+    m_statistics->incrementCounter("evdash_client_bytes_sent_total", QString::number(clientId), replayedBytes);
+    m_statistics->incrementCounter("evdash_resume_requests_total", QStringLiteral("replayed"));
+
+    qCDebug(dcEvDashExperience()) << "WebSocket client" << clientId << "resumed after sequence" << lastSeq << "Replayed" << replayed << "notifications";
+    responsePayload.insert(QStringLiteral("resumed"), true);
+    responsePayload.insert(QStringLiteral("replayed"), replayed);
+    return responsePayload;
+}
+
+void EvDashEngine::updateSnapshot()
+{
+    if (m_snapshotVersion == m_stateVersion)
+        return;
+
+    QJsonArray chargerList;
+    for (Thing *charger : qAsConst(m_chargers))
+        chargerList.append(packCharger(charger));
+
+    QJsonArray carList;
+    for (Thing *car : qAsConst(m_cars))
+        carList.append(packCar(car));
+
+    QJsonArray assignments;
+    for (const QVariant &ciVariant : chargingInfos()) {
+        const QVariantMap chargingInfo = ciVariant.toMap();
+        QJsonObject assignment;
+        assignment.insert(QStringLiteral("chargerId"), chargingInfo.value(QStringLiteral("evChargerId")).toUuid().toString(QUuid::WithoutBraces));
+        assignment.insert(QStringLiteral("assignedCarId"), chargingInfo.value(QStringLiteral("assignedCarId")).toString());
+        assignment.insert(QStringLiteral("chargingMode"), chargingInfo.value(QStringLiteral("chargingMode")).toInt());
+        assignments.append(assignment);
+    }
+
+    m_snapshot = QJsonObject();
+    m_snapshot.insert(QStringLiteral("version"), static_cast<qint64>(m_stateVersion));
+    m_snapshot.insert(QStringLiteral("seq"), static_cast<qint64>(m_notificationSequence));
+    m_snapshot.insert(QStringLiteral("chargers"), chargerList);
+    m_snapshot.insert(QStringLiteral("cars"), carList);
+    m_snapshot.insert(QStringLiteral("chargingInfos"), assignments);
+    if (m_chargingInfosStale)
+        m_snapshot.insert(QStringLiteral("chargingInfosStale"), true);
+    m_snapshot.insert(QStringLiteral("groups"), packGroups());
+    m_snapshot.insert(QStringLiteral("sessionsSummary"), m_sessionsSummary);
+
+    QElapsedTimer serializeTimer;
+    serializeTimer.start();
+    m_snapshotData = QJsonDocument(m_snapshot).toJson(QJsonDocument::Compact);
+    m_statistics->observeDuration("evdash_serialize_duration_seconds", QStringLiteral("snapshot"), serializeTimer.nsecsElapsed());
+    m_statistics->incrementCounter("evdash_snapshot_builds_total");
+
+    m_snapshotVersion = m_stateVersion;
+}
+
+QByteArray EvDashEngine::createSnapshotReply(const QString &requestId)
+{
+    updateSnapshot();
+
+    // Same layout as createSuccessResponse(), the request id is the only part encoded per request
+    QByteArray replyData;
+    replyData.reserve(m_snapshotData.size() + requestId.size() + 64);
+    if (requestId.isEmpty()) {
+        replyData.append('{');
+    } else {
+        replyData.append(QJsonDocument(QJsonObject{{QStringLiteral("requestId"), requestId}}).toJson(QJsonDocument::Compact));
+        replyData.chop(1);
+        replyData.append(',');
+    }
+
+    replyData.append("\"success\":true,\"payload\":");
+    replyData.append(m_snapshotData);
+    replyData.append('}');
+    return replyData;
+}
+
+QJsonObject EvDashEngine::createSessionsSummary(const QList<QVariantMap> &sessions) const
+{
+    double totalEnergy = 0;
+    for (const QVariantMap &session : sessions)
+        totalEnergy += session.value(QStringLiteral("sessionEnergy")).toDouble();
+
+    QList<QVariantMap> recentSessions = sessions;
+
+    const int count = qMin(s_recentSessionsCount, recentSessions.count());
+    std::partial_sort(recentSessions.begin(), recentSessions.begin() + count, recentSessions.end(), [](const QVariantMap &a, const QVariantMap &b) {
+        return a.value(QStringLiteral("endTimestamp")).toLongLong() > b.value(QStringLiteral("endTimestamp")).toLongLong();
+    });
+
+    QJsonArray recent;
+    for (int i = 0; i < count; i++)
+        recent.append(QJsonObject::fromVariantMap(recentSessions.at(i)));
+
+    QJsonObject summary;
+    summary.insert(QStringLiteral("count"), sessions.count());
+    summary.insert(QStringLiteral("totalEnergy"), totalEnergy);
+    summary.insert(QStringLiteral("recent"), recent);
+    return summary;
+}
+
+QJsonObject EvDashEngine::createStoreSummary() const
+{
+    // Count and energy come from the index columns, only the recent sessions are read
+    const EvDashSessionStore::Summary storeSummary = m_sessionStore->summary();
+
+    QJsonArray recent;
+    for (const QVariantMap &session : m_sessionStore->recentSessions(s_recentSessionsCount))
+        recent.append(QJsonObject::fromVariantMap(session));
+
+    QJsonObject summary;
+    summary.insert(QStringLiteral("count"), storeSummary.count);
+    summary.insert(QStringLiteral("totalEnergy"), storeSummary.totalEnergy);
+    summary.insert(QStringLiteral("recent"), recent);
+    return summary;
 }
 
 QJsonObject EvDashEngine::createSuccessResponse(const QString &requestId, const QJsonObject &payload) const
@@ -518,64 +2086,76 @@ QJsonObject EvDashEngine::createErrorResponse(const QString &requestId, const QS
     return response;
 }
 
-QJsonObject EvDashEngine::packCharger(Thing *charger) const
+QJsonObject EvDashEngine::packCharger(Thing *charger)
 {
-    QJsonObject chargerObject;
-    chargerObject.insert("id", charger->id().toString(QUuid::WithoutBraces));
-    chargerObject.insert("name", charger->name());
-
-    foreach (const QVariant &chargingInfoVariant, m_energyManagerClient->chargingInfos()) {
-        QVariantMap chargingInfo = chargingInfoVariant.toMap();
-        if (chargingInfo.value("evChargerId").toUuid() == charger->id()) {
-            // Set assigned car name
-            if (chargingInfo.value("assignedCarId").toString().isEmpty()) {
-                chargerObject.insert("assignedCar", "");
-            } else {
-                Thing *car = m_thingManager->findConfiguredThing(chargingInfo.value("assignedCarId").toUuid());
-                if (car) {
-                    chargerObject.insert("assignedCar", car->name());
-                } else {
-                    chargerObject.insert("assignedCar", "");
-                }
-            }
-
-            // Set energyManagerMode
-            chargerObject.insert("energyManagerMode", chargingInfo.value("chargingMode").toInt());
-        }
-    }
-
-    chargerObject.insert("connected", charger->stateValue("connected").toBool());
-    chargerObject.insert("chargingCurrent", charger->stateValue("maxChargingCurrent").toDouble());
-    chargerObject.insert("currentPower", charger->stateValue("currentPower").toDouble());
-    chargerObject.insert("pluggedIn", charger->stateValue("pluggedIn").toBool());
-    chargerObject.insert("chargingAllowed", charger->stateValue("power").toBool());
+    return EvDashChargerFields::toJson(packChargerValues(charger));
+}
 
-    if (charger->hasState("currentVersion"))
-        chargerObject.insert("version", charger->stateValue("currentVersion").toDouble());
+EvDashChargerFields::Values EvDashEngine::packChargerValues(Thing *charger)
+{
+    QElapsedTimer packTimer;
+    packTimer.start();
 
-    if (charger->hasState("sessionEnergy"))
-        chargerObject.insert("sessionEnergy", charger->stateValue("sessionEnergy").toDouble());
+    EvDashChargerFields::Values values(EvDashChargerFields::s_fieldCount);
+    values[EvDashChargerFields::FieldId] = charger->id().toString(QUuid::WithoutBraces);
+    values[EvDashChargerFields::FieldName] = charger->name();
 
-    if (charger->hasState("desiredPhaseCount"))
-        chargerObject.insert("chargingPhases", charger->stateValue("desiredPhaseCount").toInt());
+    auto assignment = m_chargerAssignments.constFind(charger->id());
+    if (assignment != m_chargerAssignments.constEnd()) {
+        // Set assigned car name
+        Thing *car = assignment->assignedCarId.isNull() ? nullptr : m_thingManager->findConfiguredThing(assignment->assignedCarId);
+        values[EvDashChargerFields::FieldAssignedCar] = car ? car->name() : QString();
 
-    // PCE specific
-    if (charger->hasState("temperature"))
-        chargerObject.insert("temperature", charger->stateValue("temperature").toDouble());
+        // Set energyManagerMode
+        values[EvDashChargerFields::FieldEnergyManagerMode] = assignment->chargingMode;
+    }
 
-    if (charger->hasState("error"))
-        chargerObject.insert("error", charger->stateValue("error").toString());
+    // Plain state values, see EvDashChargerFields::s_stateFields
+    const QVector<StateTypeId> &stateTypeIds = chargerStateTypeIds(charger).fields;
+    for (int index = 0; index < EvDashChargerFields::s_stateFieldCount; index++) {
+        const EvDashChargerFields::StateField &field = EvDashChargerFields::s_stateFields[index];
+        const StateTypeId &stateTypeId = stateTypeIds.at(index);
+        if (field.optional && stateTypeId.isNull())
+            continue;
 
-    if (charger->hasState("status"))
-        chargerObject.insert("status", charger->stateValue("status").toString());
+        values[EvDashChargerFields::DerivedFieldCount + index] = field.toJson(stateTypeId.isNull() ? QVariant() : charger->stateValue(stateTypeId));
+    }
 
     if (m_chargersStatusChangedCache.contains(charger))
-        chargerObject.insert("lastStatusUpdate", m_chargersStatusChangedCache.value(charger));
-
-    if (charger->hasState("digitalInputMode"))
-        chargerObject.insert("digitalInputMode", charger->stateValue("digitalInputMode").toInt());
+        values[EvDashChargerFields::FieldLastStatusUpdate] = m_chargersStatusChangedCache.value(charger);
+
+    // Values restored at startup which have not been confirmed yet
+    QJsonArray staleFields;
+    if (m_staleStatusUpdates.contains(charger->id()))
+        staleFields.append("lastStatusUpdate");
+    if (m_chargingInfosStale)
+        staleFields << QJsonValue("assignedCar") << QJsonValue("energyManagerMode");
+    if (!staleFields.isEmpty())
+        values[EvDashChargerFields::FieldStale] = staleFields;
+
+    m_statistics->observeDuration("evdash_pack_duration_seconds", QStringLiteral("charger"), packTimer.nsecsElapsed());
+    return values;
+}
 
-    return chargerObject;
+const EvDashEngine::ChargerStateTypeIds &EvDashEngine::chargerStateTypeIds(Thing *charger)
+{
+    auto it = m_chargerStateTypeIds.find(charger->thingClassId());
+    if (it != m_chargerStateTypeIds.end())
+        return it.value();
+
+    const StateTypes stateTypes = charger->thingClass().stateTypes();
+    ChargerStateTypeIds stateTypeIds;
+    stateTypeIds.fields.reserve(EvDashChargerFields::s_stateFieldCount);
+    for (const EvDashChargerFields::StateField &field : EvDashChargerFields::s_stateFields)
+        stateTypeIds.fields.append(stateTypes.findByName(QLatin1String(field.stateName)).id());
+
+    stateTypeIds.currentPower = stateTypes.findByName(QStringLiteral("currentPower")).id();
+    stateTypeIds.connected = stateTypes.findByName(QStringLiteral("connected")).id();
+    stateTypeIds.pluggedIn = stateTypes.findByName(QStringLiteral("pluggedIn")).id();
+    stateTypeIds.charging = stateTypes.findByName(QStringLiteral("charging")).id();
+    stateTypeIds.error = stateTypes.findByName(QStringLiteral("error")).id();
+
+    return m_chargerStateTypeIds.insert(charger->thingClassId(), stateTypeIds).value();
 }
 
 QJsonObject EvDashEngine::packCar(Thing *car) const
@@ -584,12 +2164,188 @@ QJsonObject EvDashEngine::packCar(Thing *car) const
     if (!car)
         return carObject;
 
+    QElapsedTimer packTimer;
+    packTimer.start();
+
     carObject.insert("id", car->id().toString(QUuid::WithoutBraces));
     carObject.insert("name", car->name());
 
+    m_statistics->observeDuration("evdash_pack_duration_seconds", QStringLiteral("car"), packTimer.nsecsElapsed());
     return carObject;
 }
 
+void EvDashEngine::GroupAggregate::add(const ChargerContribution &contribution, int sign)
+{
+    totalPower += sign * contribution.power;
+    chargers += sign;
+    connected += contribution.connected ? sign : 0;
+    pluggedIn += contribution.pluggedIn ? sign : 0;
+    charging += contribution.charging ? sign : 0;
+    error += contribution.error ? sign : 0;
+
+    // Do not let rounding errors of the running sum survive an empty group
+    if (chargers == 0)
+        totalPower = 0;
+}
+
+bool EvDashEngine::GroupAggregate::operator==(const GroupAggregate &other) const
+{
+    return qFuzzyCompare(totalPower + 1, other.totalPower + 1) && chargers == other.chargers && connected == other.connected && pluggedIn == other.pluggedIn
+           && charging == other.charging && error == other.error;
+}
+
+void EvDashEngine::loadGroups()
+{
+    ChargerGroup allChargers;
+    allChargers.id = s_allChargersGroupId;
+    allChargers.name = QStringLiteral("All chargers");
+    m_groups.insert(allChargers.id, allChargers);
+
+    EvDashSettings settings;
+    settings.beginGroup("Groups");
+    foreach (const QString &groupId, settings.childGroups()) {
+        if (groupId == s_allChargersGroupId)
+            continue;
+
+        ChargerGroup group;
+        settings.beginGroup(groupId);
+        group.id = groupId;
+        group.name = settings.value("name").toString();
+        group.chargerIds = settings.value("chargers").toStringList();
+        settings.endGroup(); // group id
+
+        for (const QString &chargerId : qAsConst(group.chargerIds))
+            m_chargerGroups[ThingId(chargerId)].append(group.id);
+
+        m_groups.insert(group.id, group);
+    }
+    settings.endGroup(); // Groups
+
+    qCDebug(dcEvDashExperience()) << "Loaded" << m_groups.count() - 1 << "charger groups";
+}
+
+void EvDashEngine::rebuildGroups()
+{
+    m_chargerContributions.clear();
+    for (Thing *charger : qAsConst(m_chargers))
+        m_chargerContributions.insert(charger->id(), chargerContribution(charger));
+
+    for (auto it = m_groups.begin(); it != m_groups.end(); ++it)
+        rebuildGroup(it.value());
+}
+
+void EvDashEngine::rebuildGroup(ChargerGroup &group)
+{
+    group.aggregate = GroupAggregate();
+    if (group.id == s_allChargersGroupId) {
+        for (const ChargerContribution &contribution : qAsConst(m_chargerContributions))
+            group.aggregate.add(contribution, 1);
+        return;
+    }
+
+    for (const QString &chargerId : qAsConst(group.chargerIds)) {
+        auto it = m_chargerContributions.constFind(ThingId(chargerId));
+        if (it != m_chargerContributions.constEnd())
+            group.aggregate.add(it.value(), 1);
+    }
+}
+
+void EvDashEngine::updateChargerAggregates(Thing *charger)
+{
+    auto it = m_chargerContributions.find(charger->id());
+    if (it == m_chargerContributions.end()) {
+        const ChargerContribution contribution = chargerContribution(charger);
+        applyContribution(charger->id(), nullptr, &contribution);
+        m_chargerContributions.insert(charger->id(), contribution);
+        return;
+    }
+
+    const ChargerContribution previousContribution = it.value();
+    const ChargerContribution contribution = chargerContribution(charger, &previousContribution);
+    it.value() = contribution;
+    applyContribution(charger->id(), &previousContribution, &contribution);
+}
+
+void EvDashEngine::removeChargerAggregates(const ThingId &chargerId)
+{
+    if (!m_chargerContributions.contains(chargerId))
+        return;
+
+    const ChargerContribution previousContribution = m_chargerContributions.take(chargerId);
+    applyContribution(chargerId, &previousContribution, nullptr);
+}
+
+void EvDashEngine::applyContribution(const ThingId &chargerId, const ChargerContribution *oldContribution, const ChargerContribution *newContribution)
+{
+    QStringList groupIds = m_chargerGroups.value(chargerId);
+    groupIds.prepend(s_allChargersGroupId);
+
+    for (const QString &groupId : qAsConst(groupIds)) {
+        auto it = m_groups.find(groupId);
+        if (it == m_groups.end())
+            continue;
+
+        const GroupAggregate previousAggregate = it->aggregate;
+        if (oldContribution)
+            it->aggregate.add(*oldContribution, -1);
+        if (newContribution)
+            it->aggregate.add(*newContribution, 1);
+
+        if (!(it->aggregate == previousAggregate))
+            sendNotification(QStringLiteral("GroupChanged"), packGroup(it.value()));
+    }
+}
+
+EvDashEngine::ChargerContribution EvDashEngine::chargerContribution(Thing *charger, const ChargerContribution *previousContribution)
+{
+    const ChargerStateTypeIds &stateTypeIds = chargerStateTypeIds(charger);
+
+    ChargerContribution contribution;
+    contribution.power = stateTypeIds.currentPower.isNull() ? 0 : charger->stateValue(stateTypeIds.currentPower).toDouble();
+    contribution.connected = !stateTypeIds.connected.isNull() && charger->stateValue(stateTypeIds.connected).toBool();
+    contribution.pluggedIn = !stateTypeIds.pluggedIn.isNull() && charger->stateValue(stateTypeIds.pluggedIn).toBool();
+    contribution.charging = stateTypeIds.charging.isNull() ? contribution.power > 0 : charger->stateValue(stateTypeIds.charging).toBool();
+
+    // The error text is only normalized when it changed
+    if (!stateTypeIds.error.isNull()) {
+        contribution.errorValue = charger->stateValue(stateTypeIds.error).toString();
+        if (previousContribution && previousContribution->errorValue == contribution.errorValue) {
+            contribution.error = previousContribution->error;
+        } else {
+            contribution.error = isChargerErrorValue(contribution.errorValue);
+        }
+    }
+
+    return contribution;
+}
+
+QJsonObject EvDashEngine::packGroup(const ChargerGroup &group) const
+{
+    QJsonObject groupObject;
+    groupObject.insert(QStringLiteral("id"), group.id);
+    groupObject.insert(QStringLiteral("name"), group.name);
+    groupObject.insert(QStringLiteral("chargerIds"), QJsonArray::fromStringList(group.chargerIds));
+    groupObject.insert(QStringLiteral("totalPower"), qRound64(group.aggregate.totalPower * 100) / 100.0);
+    groupObject.insert(QStringLiteral("chargers"), group.aggregate.chargers);
+    groupObject.insert(QStringLiteral("connected"), group.aggregate.connected);
+    groupObject.insert(QStringLiteral("pluggedIn"), group.aggregate.pluggedIn);
+    groupObject.insert(QStringLiteral("charging"), group.aggregate.charging);
+    groupObject.insert(QStringLiteral("error"), group.aggregate.error);
+    return groupObject;
+}
+
+QJsonArray EvDashEngine::packGroups() const
+{
+    QJsonArray groupList;
+    groupList.append(packGroup(m_groups.value(s_allChargersGroupId)));
+    for (const ChargerGroup &group : qAsConst(m_groups)) {
+        if (group.id != s_allChargersGroupId)
+            groupList.append(packGroup(group));
+    }
+
+    return groupList;
+}
+
 bool EvDashEngine::isChargerThing(Thing *thing) const
 {
     if (!thing)
@@ -618,7 +2374,7 @@ QStringList EvDashEngine::carThingIdsForCharger(const QString &chargerId) const
     if (chargerUuid.isNull())
         return carThingIds;
 
-    for (const QVariant &ciVariant : m_energyManagerClient->chargingInfos()) {
+    for (const QVariant &ciVariant : chargingInfos()) {
         const QVariantMap chargingInfo = ciVariant.toMap();
         if (chargingInfo.value(QStringLiteral("evChargerId")).toUuid() != chargerUuid)
             continue;
@@ -633,39 +2389,101 @@ QStringList EvDashEngine::carThingIdsForCharger(const QString &chargerId) const
     return carThingIds;
 }
 
-void EvDashEngine::onSessionsReceived(const QList<QVariantMap> &sessions)
+QJsonObject EvDashEngine::createSessionsPayload(const QList<QVariantMap> &sessions) const
 {
-    qCDebug(dcEvDashExperience()) << "ChargingSessions received:" << sessions.count();
-
     QJsonArray sessionArray;
     for (const QVariantMap &session : sessions)
         sessionArray.append(QJsonObject::fromVariantMap(session));
 
     QJsonObject payload;
     payload.insert(QStringLiteral("sessions"), sessionArray);
+    return payload;
+}
+
+void EvDashEngine::requestSessionSync()
+{
+    if (m_sessionSyncInFlight)
+        return;
 
+    // Sessions can be reported late with an end time before the newest known one, so
+    // the overlap window before it is fetched again. The store skips unchanged sessions.
+    const qint64 startTimestamp = qMax<qint64>(0, m_sessionStore->newestEndTimestamp() - m_sessionSyncOverlap);
+    m_sessionSyncInFlight = true;
+    m_chargingSessionsClient->getSessions(QStringList(), startTimestamp);
+}
+
+void EvDashEngine::onSessionsReceived(const QList<QVariantMap> &sessions, const QStringList &carThingIds)
+{
+    qCDebug(dcEvDashExperience()) << "ChargingSessions received:" << sessions.count();
+
+    if (!m_sessionStore) {
+        const QJsonObject payload = createSessionsPayload(sessions);
+
+        // The snapshot summarizes the complete session list only
+        if (carThingIds.isEmpty()) {
+            m_sessionsSummary = createSessionsSummary(sessions);
+            markStateChanged();
+        }
+
+        // Every request issued its own call, the reply answers the requests with the same car filter
+        const QList<QString> pendingRequestIds = m_pendingChargingSessionsRequests.keys();
+        for (const QString &requestId : pendingRequestIds) {
+            const PendingRequest pendingRequest = m_pendingChargingSessionsRequests.value(requestId);
+            if (pendingRequest.carThingIds != carThingIds)
+                continue;
+
+            if (pendingRequest.startTimestamp == 0 && pendingRequest.endTimestamp == 0) {
+                finishPendingRequest(requestId, createSuccessResponse(requestId, payload));
+                continue;
+            }
+
+            QList<QVariantMap> sessionsInRange;
+            for (const QVariantMap &session : sessions) {
+                const qint64 endTimestamp = session.value(QStringLiteral("endTimestamp")).toLongLong();
+                if (endTimestamp >= pendingRequest.startTimestamp && (pendingRequest.endTimestamp == 0 || endTimestamp <= pendingRequest.endTimestamp))
+                    sessionsInRange.append(session);
+            }
+            finishPendingRequest(requestId, createSuccessResponse(requestId, createSessionsPayload(sessionsInRange)));
+        }
+
+        sendNotification(QStringLiteral("chargingSessionsUpdated"), payload);
+        return;
+    }
+
+    m_sessionSyncInFlight = false;
+    m_sessionStoreSynced = true;
+
+    const bool incremental = m_sessionStore->count() > 0;
+    QList<QVariantMap> changedSessions;
+    m_sessionStore->append(sessions, &changedSessions);
+    qCDebug(dcEvDashExperience()) << "Session store sync:" << changedSessions.count() << "new or changed sessions," << m_sessionStore->count() << "total";
+
+    // Requests are answered from the index, only the matching records are decoded
     const QList<QString> pendingRequestIds = m_pendingChargingSessionsRequests.keys();
     for (const QString &requestId : pendingRequestIds) {
-        QPointer<QWebSocket> socket = m_pendingChargingSessionsRequests.take(requestId);
-        if (!socket)
-            continue;
-
-        sendReply(socket, createSuccessResponse(requestId, payload));
+        const PendingRequest pendingRequest = m_pendingChargingSessionsRequests.value(requestId);
+        const QList<QVariantMap> storedSessions = m_sessionStore->sessions(pendingRequest.carThingIds, pendingRequest.startTimestamp, pendingRequest.endTimestamp);
+        finishPendingRequest(requestId, createSuccessResponse(requestId, createSessionsPayload(storedSessions)));
     }
 
+    if (changedSessions.isEmpty())
+        return;
+
+    m_sessionsSummary = createStoreSummary();
+    markStateChanged();
+
+    QJsonObject payload = createSessionsPayload(changedSessions);
+    payload.insert(QStringLiteral("incremental"), incremental);
     sendNotification(QStringLiteral("chargingSessionsUpdated"), payload);
 }
 
 void EvDashEngine::onSessionsError(const QString &errorMessage)
 {
     qCWarning(dcEvDashExperience()) << "Charging sessions DBus client error occurred:" << errorMessage;
+    m_sessionSyncInFlight = false;
 
     const QList<QString> pendingRequestIds = m_pendingChargingSessionsRequests.keys();
     for (const QString &requestId : pendingRequestIds) {
-        QPointer<QWebSocket> socket = m_pendingChargingSessionsRequests.take(requestId);
-        if (!socket)
-            continue;
-
-        sendReply(socket, createErrorResponse(requestId, errorMessage));
+        finishPendingRequest(requestId, createErrorResponse(requestId, errorMessage));
     }
 }
@@ -25,21 +25,33 @@
 #ifndef EVDASHENGINE_H
 #define EVDASHENGINE_H
 
+#include <QElapsedTimer>
 #include <QHash>
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QObject>
-#include <QPointer>
+#include <QQueue>
+#include <QSet>
 #include <QStringList>
+#include <QVariantList>
+#include <QVector>
 
 #include <integrations/thing.h>
 
-class QWebSocket;
-class QWebSocketServer;
+#include "evdashchargerfields.h"
+
+class QSslConfiguration;
+class QTimer;
 
 class Thing;
 class LogEngine;
 class ThingManager;
 class EnergyManagerDbusClient;
+class EvDashSessionStore;
+class EvDashSettingsStore;
+class EvDashStatistics;
+class EvDashTracer;
+class EvDashWebSocketServer;
 class EvDashWebServerResource;
 class ChargingSessionsDBusInterfaceClient;
 
@@ -47,18 +59,35 @@ class EvDashEngine : public QObject
 {
     Q_OBJECT
 public:
-    enum EvDashError { EvDashErrorNoError = 0, EvDashErrorBackendError, EvDashErrorDuplicateUser, EvDashErrorUserNotFound, EvDashErrorBadPassword };
+    enum EvDashError { EvDashErrorNoError = 0, EvDashErrorBackendError, EvDashErrorDuplicateUser, EvDashErrorUserNotFound, EvDashErrorBadPassword, EvDashErrorGroupNotFound, EvDashErrorInvalidGroup };
     Q_ENUM(EvDashError)
 
-    explicit EvDashEngine(ThingManager *thingManager, LogEngine *logEngine, EvDashWebServerResource *webServerResource, QObject *parent = nullptr);
+    explicit EvDashEngine(ThingManager *thingManager, LogEngine *logEngine, EvDashWebServerResource *webServerResource, EvDashSettingsStore *settingsStore, EvDashStatistics *statistics, QObject *parent = nullptr);
     ~EvDashEngine() override;
 
     bool enabled() const;
     bool setEnabled(bool enabled);
 
+    // Read only state for the REST API. The ETag changes whenever the state
+    // does, encoded representations are cached until then.
+    QByteArray stateETag() const;
+    QByteArray encodedState(const QString &resource, bool *found);
+
+    // Change feed, things modified after the given state version
+    QString epoch() const;
+    quint64 stateVersion() const;
+    QJsonObject changesSince(quint64 version, const QString &epoch);
+
+    // Charger groups with aggregated values. The group "all" contains every charger.
+    QVariantList groups() const;
+    EvDashError setGroup(const QString &groupId, const QString &name, const QStringList &chargerIds, QString *resultGroupId);
+    EvDashError removeGroup(const QString &groupId);
+
 signals:
     void enabledChanged(bool enabled);
     void webSocketListeningChanged(bool listening);
+    void stateChanged(quint64 version);
+    void groupsChanged();
 
 private slots:
     void onThingAdded(Thing *thing);
@@ -66,19 +95,56 @@ private slots:
     void onThingChanged(Thing *thing);
 
 private:
+    friend class EvDashEngineBenchmark;
+
     ThingManager *m_thingManager = nullptr;
     LogEngine *m_logEngine = nullptr;
     EvDashWebServerResource *m_webServerResource = nullptr;
+    EvDashSettingsStore *m_settingsStore = nullptr;
+    EvDashStatistics *m_statistics = nullptr;
+    EvDashTracer *m_tracer = nullptr;
     bool m_enabled = false;
 
     EnergyManagerDbusClient *m_energyManagerClient = nullptr;
     ChargingSessionsDBusInterfaceClient *m_chargingSessionsClient = nullptr;
 
-    QWebSocketServer *m_webSocketServer = nullptr;
+    // Local copy of the session history. Once synced, session requests are
+    // answered from the store and only recent sessions are fetched from the service.
+    EvDashSessionStore *m_sessionStore = nullptr;
+    bool m_sessionStoreSynced = false;
+    bool m_sessionSyncInFlight = false;
+    // Seconds before the newest stored end timestamp which every sync fetches again
+    qint64 m_sessionSyncOverlap = 7 * 24 * 3600;
+
+    EvDashWebSocketServer *m_webSocketServer = nullptr;
     quint16 m_webSocketPort = 4449;
+    // TLS was requested but could not be set up, the server refuses to listen
+    bool m_webSocketTlsError = false;
+
+    QList<quint64> m_clients;
+    QHash<quint64, QString> m_authenticatedClients;
+    int m_authenticationTimeout = 10000;
+
+    // Every notification carries a sequence number. The last ones are kept
+    // encoded so reconnecting clients can resume without a full reload. The
+    // epoch changes with every engine instance, sequence numbers restart then.
+    // Clients resume within authenticate, so the missed frames are queued before
+    // the client receives live notifications again.
+    struct ReplayEntry
+    {
+        quint64 sequence = 0;
+        QByteArray frame;
+    };
+
+    QString m_notificationEpoch;
+    quint64 m_notificationSequence = 0;
+    QQueue<ReplayEntry> m_replayLog;
+    qint64 m_replayLogBytes = 0;
+    int m_replayLogSize = 1024;
+    qint64 m_replayLogMaxBytes = 4 * 1024 * 1024;
 
-    QList<QWebSocket *> m_clients;
-    QHash<QWebSocket *, QString> m_authenticatedClients;
+    void appendToReplayLog(quint64 sequence, const QByteArray &frame);
+    QJsonObject resume(quint64 clientId, const QJsonObject &resumeObject);
 
     QList<Thing *> m_cars;
     QList<Thing *> m_chargers;
@@ -89,28 +155,263 @@ private:
     QHash<Thing *, qint64> m_chargersStatusChangedCache;
     void verifyChargerStatusChanged(Thing *charger);
 
+    // Warm start. Status timestamps and charging infos are restored from the last
+    // run and reported as stale until the log engine and energy manager confirm them.
+    static constexpr int s_warmStartFormatVersion = 1;
+    QString m_warmStartFileName;
+    QTimer *m_warmStartTimer = nullptr;
+    quint64 m_warmStartVersion = 0;
+    QVariantList m_warmStartChargingInfos;
+    QSet<ThingId> m_staleStatusUpdates;
+    bool m_chargingInfosStale = false;
+
+    void loadWarmStart();
+    void saveWarmStart();
+    QVariantList chargingInfos() const;
+
+    // The charging infos by charger, so packing a charger does not walk the whole list
+    struct ChargerAssignment
+    {
+        ThingId assignedCarId;
+        int chargingMode = 0;
+    };
+    QHash<ThingId, ChargerAssignment> m_chargerAssignments;
+    void rebuildChargerAssignments();
+    void updateChargerAssignment(const QVariantMap &chargingInfo);
+
+    // Charger groups. Every charger contributes its last known values to the
+    // aggregates of its groups, a state change only applies the difference.
+    struct ChargerContribution
+    {
+        double power = 0;
+        bool connected = false;
+        bool pluggedIn = false;
+        bool charging = false;
+        bool error = false;
+        // The error state the error flag was derived from
+        QString errorValue;
+    };
+
+    struct GroupAggregate
+    {
+        double totalPower = 0;
+        int chargers = 0;
+        int connected = 0;
+        int pluggedIn = 0;
+        int charging = 0;
+        int error = 0;
+
+        void add(const ChargerContribution &contribution, int sign);
+        bool operator==(const GroupAggregate &other) const;
+    };
+
+    struct ChargerGroup
+    {
+        QString id;
+        QString name;
+        QStringList chargerIds;
+        GroupAggregate aggregate;
+    };
+
+    QHash<QString, ChargerGroup> m_groups;
+    QHash<ThingId, QStringList> m_chargerGroups;
+    QHash<ThingId, ChargerContribution> m_chargerContributions;
+
+    void loadGroups();
+    void rebuildGroups();
+    void rebuildGroup(ChargerGroup &group);
+    void updateChargerAggregates(Thing *charger);
+    void removeChargerAggregates(const ThingId &chargerId);
+    void applyContribution(const ThingId &chargerId, const ChargerContribution *oldContribution, const ChargerContribution *newContribution);
+    ChargerContribution chargerContribution(Thing *charger, const ChargerContribution *previousContribution = nullptr);
+    QJsonObject packGroup(const ChargerGroup &group) const;
+    QJsonArray packGroups() const;
+
+    // GetSnapshot. The version advances with every state change, the cached
+    // snapshot is rebuilt on the next request after that.
+    quint64 m_stateVersion = 1;
+    quint64 m_snapshotVersion = 0;
+    QJsonObject m_snapshot;
+    QByteArray m_snapshotData;
+    QJsonObject m_sessionsSummary;
+
+    quint64 m_restCacheVersion = 0;
+    QHash<QString, QByteArray> m_restCache;
+
+    // State version of the last change per thing, removed things are remembered
+    // for a while. Older changes can only be reported as a full reset.
+    QHash<ThingId, quint64> m_thingVersions;
+    QHash<ThingId, quint64> m_removedThings;
+    quint64 m_removedThingsHorizon = 0;
+    static constexpr int s_maxRemovedThings = 256;
+
+    void markStateChanged();
+    void markThingChanged(Thing *thing);
+    void markThingRemoved(const ThingId &thingId);
+
+    void updateSnapshot();
+    QByteArray createSnapshotReply(const QString &requestId);
+    QJsonObject createSessionsSummary(const QList<QVariantMap> &sessions) const;
+    QJsonObject createStoreSummary() const;
+
+    struct PendingRequest
+    {
+        quint64 clientId = 0;
+        QString action;
+        QElapsedTimer timer;
+        // Set for requests which are part of a batch
+        QString batchKey;
+        int batchIndex = -1;
+        // Car filter and end timestamp range of GetChargingSessions, 0 means unbounded
+        QStringList carThingIds;
+        qint64 startTimestamp = 0;
+        qint64 endTimestamp = 0;
+        // Tracer timestamps, only set while tracing is enabled
+        qint64 traceStart = 0;
+        qint64 backendStart = 0;
+    };
+
     // Pending requests waiting for charging sessions data to return
-    QHash<QString, QPointer<QWebSocket>> m_pendingChargingSessionsRequests;
+    QHash<QString, PendingRequest> m_pendingChargingSessionsRequests;
+    PendingRequest *findPendingRequest(quint64 clientId, const QString &requestId);
+
+    // Charger actions, only accepted if enabled in the ChargerActions settings.
+    // All actions of a request are dispatched at once and answered in one reply.
+    // The request is pending under the client and its request id, the actions under
+    // an internal id, so late results of a finished request never reach a newer one.
+    struct PendingChargerActions
+    {
+        quint64 clientId = 0;
+        QString requestId;
+        QJsonArray results;
+        int outstanding = 0;
+        QTimer *timeoutTimer = nullptr;
+    };
+    bool m_chargerActionsEnabled = false;
+    int m_chargerActionsTimeout = 10000;
+    int m_maxChargerActions = 256;
+    QHash<QString, PendingRequest> m_pendingActionRequests;
+    QHash<quint64, PendingChargerActions> m_pendingChargerActions;
+    quint64 m_chargerActionsSequence = 0;
+    QJsonObject executeChargerActions(quint64 clientId, const QString &requestId, const QJsonObject &payload);
+    void finishChargerAction(quint64 actionsId, int index, const QString &status, const QString &displayMessage);
+    void finishChargerActions(quint64 actionsId);
+
+    // Batches waiting for asynchronous sub requests
+    struct PendingBatch
+    {
+        quint64 clientId = 0;
+        QString requestId;
+        QStringList requestIds;
+        QVector<QJsonObject> responses;
+        int outstanding = 0;
+        QElapsedTimer timer;
+    };
+
+    QHash<QString, PendingBatch> m_pendingBatches;
+    int m_maxBatchSize = 32;
     QStringList carThingIdsForCharger(const QString &chargerId) const;
     bool isChargerThing(Thing *thing) const;
     bool isCarThing(Thing *thing) const;
 
+    // Things, DBus clients and the WebSocket server only exist while the service is enabled
+    bool m_servicesStarted = false;
+    bool applyEnabled(bool enabled);
+    void startServices();
+    void stopServices();
+
     // Websocket server
     bool startWebSocketServer(quint16 port = 0);
+    bool loadSslConfiguration(QSslConfiguration *configuration) const;
     void stopWebSocketServer();
-    void processTextMessage(QWebSocket *socket, const QString &message);
+    void onClientConnected(quint64 clientId);
+    void onClientDisconnected(quint64 clientId);
+    void processRequest(quint64 clientId, const QJsonObject &requestObject);
+    void onInvalidRequest(quint64 clientId, const QString &errorString);
 
     // Websocket API
-    QJsonObject handleApiRequest(QWebSocket *socket, const QJsonObject &request);
-    void sendReply(QWebSocket *socket, QJsonObject response) const;
-    void sendNotification(const QString &notification, QJsonObject payload) const;
+    QJsonObject handleApiRequest(quint64 clientId, const QJsonObject &request);
+    QJsonObject handleBatch(quint64 clientId, const QString &requestId, const QJsonObject &payload);
+    void finishBatchRequest(const QString &batchKey, int index, const QJsonObject &response);
+    QJsonObject createBatchResponse(const PendingBatch &batch) const;
+    void sendReply(quint64 clientId, QJsonObject response) const;
+    void sendReplyData(quint64 clientId, const QByteArray &replyData, const QString &traceId = QString()) const;
+    void finishPendingRequest(const QString &requestId, const QJsonObject &response);
+    void finishPendingRequest(const QString &requestId, const PendingRequest &pendingRequest, const QJsonObject &response);
+    // Charger notifications pass the packed charger values, clients with a field mask get projections of them
+    void sendNotification(const QString &notification, QJsonObject payload, const QString &traceId = QString(), quint32 changedFields = 0xffffffff, const EvDashChargerFields::Values &fieldValues = EvDashChargerFields::Values());
+    void deliverNotification(const QString &notification, QJsonObject notificationObject, const QByteArray &notificationData, QList<quint64> recipients, quint32 changedFields, const EvDashChargerFields::Values &fieldValues, const QString &traceId);
+    void sendNotificationData(const QString &notification, const QList<quint64> &recipients, const QByteArray &notificationData, const QString &traceId);
+
+    // Charger field projection, set with the Subscribe action. Clients without
+    // a mask receive complete chargers.
+    QHash<quint64, quint32> m_clientChargerFieldMasks;
+    QJsonObject subscribe(quint64 clientId, const QString &requestId, const QJsonObject &payload);
+
+    // Rate limited clients, set with the maxRate of the Subscribe action. Clients
+    // with the same flush interval share a rate class, which keeps only the latest
+    // ChargerChanged notification per charger until its timer fires.
+    struct PendingNotification
+    {
+        QJsonObject notificationObject;
+        QByteArray notificationData;
+        EvDashChargerFields::Values fieldValues;
+        quint32 changedFields = 0;
+    };
+    struct RateClass
+    {
+        QTimer *timer = nullptr;
+        QList<quint64> clients;
+        QHash<QString, PendingNotification> pending;
+    };
+    QHash<int, RateClass> m_rateClasses;
+    QHash<quint64, int> m_clientRateClasses;
+    void setClientRateClass(quint64 clientId, int interval);
+    void flushRateClass(int interval);
+
+    // Last packed state per charger, notifications are only sent for changed fields
+    QHash<ThingId, EvDashChargerFields::Values> m_chargerPayloads;
+    void notifyChargerChanged(Thing *charger, const QString &traceId = QString(), bool applyDeadbands = true);
+
+    // Numeric charger fields only count as changed once they leave the deadband
+    // around the last sent value. The refresh timer sends the exact values.
+    // Deadbands are stored by field mask bit.
+    struct Deadband
+    {
+        double absolute;
+        double relative;
+    };
+    QHash<int, Deadband> m_deadbands;
+    QTimer *m_deadbandRefreshTimer = nullptr;
+    void loadDeadbands();
+    void refreshChargers();
 
     QJsonObject createSuccessResponse(const QString &requestId, const QJsonObject &payload = {}) const;
     QJsonObject createErrorResponse(const QString &requestId, const QString &errorMessage) const;
 
-    QJsonObject packCharger(Thing *charger) const;
+    QJsonObject packCharger(Thing *charger);
+    EvDashChargerFields::Values packChargerValues(Thing *charger);
+
+    // State type ids of the charger states per thing class, looked up by name once.
+    // A null id marks a state the thing class does not have.
+    struct ChargerStateTypeIds
+    {
+        // In the order of EvDashChargerFields::s_stateFields
+        QVector<StateTypeId> fields;
+        // Used by the group aggregates
+        StateTypeId currentPower;
+        StateTypeId connected;
+        StateTypeId pluggedIn;
+        StateTypeId charging;
+        StateTypeId error;
+    };
+    QHash<ThingClassId, ChargerStateTypeIds> m_chargerStateTypeIds;
+    const ChargerStateTypeIds &chargerStateTypeIds(Thing *charger);
+
     QJsonObject packCar(Thing *car) const;
-    void onSessionsReceived(const QList<QVariantMap> &sessions);
+    QJsonObject createSessionsPayload(const QList<QVariantMap> &sessions) const;
+    void requestSessionSync();
+    void onSessionsReceived(const QList<QVariantMap> &sessions, const QStringList &carThingIds);
     void onSessionsError(const QString &errorMessage);
 };
 
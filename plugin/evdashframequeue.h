@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef EVDASHFRAMEQUEUE_H
+#define EVDASHFRAMEQUEUE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+
+// A WebSocket frame encoded once by the engine and sent to all listed clients.
+struct EvDashFrame
+{
+    QVector<quint64> clientIds;
+    QByteArray payload;
+    bool binary = false;
+    // Set when request tracing is enabled, the write is recorded as a span of this trace
+    QString traceId;
+};
+
+// Unbounded lock free single producer / single consumer queue. The engine
+// thread pushes, exactly one socket worker thread pops.
+template<typename T>
+class EvDashFrameQueue
+{
+public:
+    EvDashFrameQueue()
+    {
+        Node *stub = new Node;
+        m_head.store(stub, std::memory_order_relaxed);
+        m_tail = stub;
+    }
+
+    ~EvDashFrameQueue()
+    {
+        Node *node = m_tail;
+        while (node) {
+            Node *next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+
+    EvDashFrameQueue(const EvDashFrameQueue &) = delete;
+    EvDashFrameQueue &operator=(const EvDashFrameQueue &) = delete;
+
+    // Producer side
+    void push(const T &value)
+    {
+        Node *node = new Node;
+        node->value = value;
+        m_head.load(std::memory_order_relaxed)->next.store(node, std::memory_order_release);
+        m_head.store(node, std::memory_order_relaxed);
+        m_size.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Consumer side
+    bool pop(T *value)
+    {
+        Node *next = m_tail->next.load(std::memory_order_acquire);
+        if (!next)
+            return false;
+
+        *value = std::move(next->value);
+        next->value = T();
+        delete m_tail;
+        m_tail = next;
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Approximate, for statistics only
+    int size() const { return m_size.load(std::memory_order_relaxed); }
+
+private:
+    struct Node
+    {
+        std::atomic<Node *> next{nullptr};
+        T value;
+    };
+
+    // m_head is only touched by the producer, m_tail only by the consumer
+    std::atomic<Node *> m_head;
+    Node *m_tail = nullptr;
+    std::atomic<int> m_size{0};
+};
+
+#endif // EVDASHFRAMEQUEUE_H
@@ -24,16 +24,18 @@
 
 #include "evdashjsonhandler.h"
 #include "evdashengine.h"
+#include "evdashstatistics.h"
 #include "evdashwebserverresource.h"
 
 #include <QLoggingCategory>
 
 Q_DECLARE_LOGGING_CATEGORY(dcEvDashExperience)
 
-EvDashJsonHandler::EvDashJsonHandler(EvDashEngine *engine, EvDashWebServerResource *resource, QObject *parent)
+EvDashJsonHandler::EvDashJsonHandler(EvDashEngine *engine, EvDashWebServerResource *resource, EvDashStatistics *statistics, QObject *parent)
     : JsonHandler{parent}
     , m_engine{engine}
     , m_resource{resource}
+    , m_statistics{statistics}
 {
     registerEnum<EvDashEngine::EvDashError>();
 
@@ -74,6 +76,54 @@ EvDashJsonHandler::EvDashJsonHandler(EvDashEngine *engine, EvDashWebServerResour
     returns.insert("evDashError", enumRef<EvDashEngine::EvDashError>());
     registerMethod("RemoveUser", description, params, returns);
 
+    params.clear();
+    returns.clear();
+    description = "Add several users at once. Each entry of the list contains a username and a password. Either all users "
+                  "are added or none, in case of an error the username causing it is returned.";
+    params.insert("users", QVariantList() << enumValueName(Object));
+    returns.insert("evDashError", enumRef<EvDashEngine::EvDashError>());
+    returns.insert("o:username", enumValueName(String));
+    registerMethod("AddUsers", description, params, returns);
+
+    params.clear();
+    returns.clear();
+    description = "Remove several users at once. Either all users are removed or none, in case of an error the username "
+                  "causing it is returned.";
+    params.insert("usernames", enumValueName(StringList));
+    returns.insert("evDashError", enumRef<EvDashEngine::EvDashError>());
+    returns.insert("o:username", enumValueName(String));
+    registerMethod("RemoveUsers", description, params, returns);
+
+    params.clear();
+    returns.clear();
+    description = "Get the runtime statistics of the EV Dash service. Each metric contains its type, a help text and the list of "
+                  "samples. Histogram samples contain the count, sum, max and average duration in seconds and the cumulative buckets.";
+    returns.insert("statistics", enumValueName(Object));
+    registerMethod("GetStatistics", description, params, returns);
+
+    params.clear();
+    returns.clear();
+    description = "Get the charger groups and their aggregated values. The group with the id \"all\" contains every charger.";
+    returns.insert("groups", QVariantList() << enumValueName(Object));
+    registerMethod("GetGroups", description, params, returns);
+
+    params.clear();
+    returns.clear();
+    description = "Add a new charger group or change an existing one. If no groupId is given a new group will be created.";
+    params.insert("o:groupId", enumValueName(String));
+    params.insert("name", enumValueName(String));
+    params.insert("chargerIds", enumValueName(StringList));
+    returns.insert("evDashError", enumRef<EvDashEngine::EvDashError>());
+    returns.insert("o:groupId", enumValueName(String));
+    registerMethod("SetGroup", description, params, returns);
+
+    params.clear();
+    returns.clear();
+    description = "Remove the charger group with the given id.";
+    params.insert("groupId", enumValueName(String));
+    returns.insert("evDashError", enumRef<EvDashEngine::EvDashError>());
+    registerMethod("RemoveGroup", description, params, returns);
+
     // Notifications
     params.clear();
     description = "Emitted whenever the EV Dash service has been enabled or disabled.";
@@ -95,6 +145,13 @@ EvDashJsonHandler::EvDashJsonHandler(EvDashEngine *engine, EvDashWebServerResour
     registerNotification("UserRemoved", description, params);
 
     connect(m_resource, &EvDashWebServerResource::userRemoved, this, [this](const QString &username) { emit UserRemoved({{"username", username}}); });
+
+    params.clear();
+    description = "Emitted whenever a charger group has been added, changed or removed.";
+    params.insert("groups", QVariantList() << enumValueName(Object));
+    registerNotification("GroupsChanged", description, params);
+
+    connect(m_engine, &EvDashEngine::groupsChanged, this, [this]() { emit GroupsChanged({{"groups", m_engine->groups()}}); });
 }
 
 QString EvDashJsonHandler::name() const
@@ -155,3 +212,80 @@ JsonReply *EvDashJsonHandler::RemoveUser(const QVariantMap &params)
     returns.insert("evDashError", enumValueName(error));
     return createReply(returns);
 }
+
+JsonReply *EvDashJsonHandler::AddUsers(const QVariantMap &params)
+{
+    QList<QPair<QString, QString>> users;
+    foreach (const QVariant &userVariant, params.value("users").toList()) {
+        const QVariantMap user = userVariant.toMap();
+        users.append(qMakePair(user.value("username").toString(), user.value("password").toString()));
+    }
+
+    QString failedUsername;
+    EvDashEngine::EvDashError error = m_resource->addUsers(users, &failedUsername);
+
+    QVariantMap returns;
+    returns.insert("evDashError", enumValueName(error));
+    if (error != EvDashEngine::EvDashErrorNoError)
+        returns.insert("username", failedUsername);
+    return createReply(returns);
+}
+
+JsonReply *EvDashJsonHandler::RemoveUsers(const QVariantMap &params)
+{
+    QStringList usernames = params.value("usernames").toStringList();
+
+    QString failedUsername;
+    EvDashEngine::EvDashError error = m_resource->removeUsers(usernames, &failedUsername);
+
+    QVariantMap returns;
+    returns.insert("evDashError", enumValueName(error));
+    if (error != EvDashEngine::EvDashErrorNoError)
+        returns.insert("username", failedUsername);
+    return createReply(returns);
+}
+
+JsonReply *EvDashJsonHandler::GetStatistics(const QVariantMap &params)
+{
+    Q_UNUSED(params)
+
+    QVariantMap returns;
+    returns.insert("statistics", m_statistics->toVariantMap());
+    return createReply(returns);
+}
+
+JsonReply *EvDashJsonHandler::GetGroups(const QVariantMap &params)
+{
+    Q_UNUSED(params)
+
+    QVariantMap returns;
+    returns.insert("groups", m_engine->groups());
+    return createReply(returns);
+}
+
+JsonReply *EvDashJsonHandler::SetGroup(const QVariantMap &params)
+{
+    QString groupId = params.value("groupId").toString();
+    QString name = params.value("name").toString();
+    QStringList chargerIds = params.value("chargerIds").toStringList();
+
+    QString resultGroupId;
+    EvDashEngine::EvDashError error = m_engine->setGroup(groupId, name, chargerIds, &resultGroupId);
+
+    QVariantMap returns;
+    returns.insert("evDashError", enumValueName(error));
+    if (error == EvDashEngine::EvDashErrorNoError)
+        returns.insert("groupId", resultGroupId);
+    return createReply(returns);
+}
+
+JsonReply *EvDashJsonHandler::RemoveGroup(const QVariantMap &params)
+{
+    QString groupId = params.value("groupId").toString();
+
+    EvDashEngine::EvDashError error = m_engine->removeGroup(groupId);
+
+    QVariantMap returns;
+    returns.insert("evDashError", enumValueName(error));
+    return createReply(returns);
+}
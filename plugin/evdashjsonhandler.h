@@ -30,13 +30,14 @@
 #include <jsonrpc/jsonhandler.h>
 
 class EvDashEngine;
+class EvDashStatistics;
 class EvDashWebServerResource;
 
 class EvDashJsonHandler : public JsonHandler
 {
     Q_OBJECT
 public:
-    explicit EvDashJsonHandler(EvDashEngine *engine, EvDashWebServerResource *resource, QObject *parent = nullptr);
+    explicit EvDashJsonHandler(EvDashEngine *engine, EvDashWebServerResource *resource, EvDashStatistics *statistics, QObject *parent = nullptr);
 
     QString name() const override;
 
@@ -46,6 +47,14 @@ public:
     Q_INVOKABLE JsonReply *GetUsers(const QVariantMap &params);
     Q_INVOKABLE JsonReply *AddUser(const QVariantMap &params);
     Q_INVOKABLE JsonReply *RemoveUser(const QVariantMap &params);
+    Q_INVOKABLE JsonReply *AddUsers(const QVariantMap &params);
+    Q_INVOKABLE JsonReply *RemoveUsers(const QVariantMap &params);
+
+    Q_INVOKABLE JsonReply *GetStatistics(const QVariantMap &params);
+
+    Q_INVOKABLE JsonReply *GetGroups(const QVariantMap &params);
+    Q_INVOKABLE JsonReply *SetGroup(const QVariantMap &params);
+    Q_INVOKABLE JsonReply *RemoveGroup(const QVariantMap &params);
 
 signals:
     void EnabledChanged(const QVariantMap &params);
@@ -53,9 +62,12 @@ signals:
     void UserAdded(const QVariantMap &params);
     void UserRemoved(const QVariantMap &params);
 
+    void GroupsChanged(const QVariantMap &params);
+
 private:
     EvDashEngine *m_engine = nullptr;
     EvDashWebServerResource *m_resource = nullptr;
+    EvDashStatistics *m_statistics = nullptr;
 };
 
 #endif // ENERGYJSONHANDLER_H
@@ -0,0 +1,540 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "evdashsessionstore.h"
+
+#include <QCborValue>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+#include <QLoggingCategory>
+Q_DECLARE_LOGGING_CATEGORY(dcEvDashExperience)
+
+// File layout: "EVDSESS2", followed by records of a fixed little endian header
+// (magic, payload length, session key, start, end, car id, charger id, energy,
+// reserved) and the session as CBOR. Files of the first version are started over.
+static const QByteArray s_fileMagic = QByteArrayLiteral("EVDSESS2");
+static const quint32 s_recordMagic = 0x52535645; // "EVSR"
+
+// The file is rewritten once superseded records take more than this and half of the file
+static const qint64 s_compactionThreshold = 1024 * 1024;
+
+static quint64 energyBits(double energy)
+{
+    quint64 bits;
+    memcpy(&bits, &energy, sizeof(bits));
+    return bits;
+}
+
+static double energyFromBits(quint64 bits)
+{
+    double energy;
+    memcpy(&energy, &bits, sizeof(energy));
+    return energy;
+}
+
+EvDashSessionStore::EvDashSessionStore(const QString &fileName)
+    : m_file{fileName}
+{}
+
+EvDashSessionStore::~EvDashSessionStore()
+{
+    close();
+}
+
+bool EvDashSessionStore::open()
+{
+    if (isOpen())
+        return true;
+
+    QDir().mkpath(QFileInfo(m_file.fileName()).absolutePath());
+    if (!m_file.open(QFile::ReadWrite)) {
+        qCWarning(dcEvDashExperience()) << "Could not open session store" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+
+    if (m_file.size() == 0) {
+        m_file.write(s_fileMagic);
+        m_file.flush();
+    }
+
+    m_file.seek(0);
+    if (m_file.size() < s_fileHeaderSize || m_file.read(s_fileHeaderSize) != s_fileMagic) {
+        qCWarning(dcEvDashExperience()) << "Session store" << m_file.fileName() << "has an old or unknown format. Starting over.";
+        m_file.resize(0);
+        m_file.seek(0);
+        m_file.write(s_fileMagic);
+        m_file.flush();
+    }
+
+    if (!remap() || !loadIndex()) {
+        close();
+        return false;
+    }
+
+    qCDebug(dcEvDashExperience()) << "Session store" << m_file.fileName() << "contains" << count() << "sessions of" << m_carIds.count() << "cars";
+    return true;
+}
+
+void EvDashSessionStore::close()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+        m_mapSize = 0;
+    }
+
+    m_file.close();
+    clearIndex();
+}
+
+bool EvDashSessionStore::isOpen() const
+{
+    return m_file.isOpen() && m_map;
+}
+
+QString EvDashSessionStore::fileName() const
+{
+    return m_file.fileName();
+}
+
+int EvDashSessionStore::count() const
+{
+    return m_endTimestamps.count();
+}
+
+qint64 EvDashSessionStore::newestEndTimestamp() const
+{
+    return m_endTimestamps.isEmpty() ? 0 : m_endTimestamps.last();
+}
+
+int EvDashSessionStore::append(const QList<QVariantMap> &sessions, QList<QVariantMap> *changedSessions)
+{
+    if (!isOpen())
+        return 0;
+
+    QByteArray data;
+    QVector<IndexEntry> entries;
+    QVector<QByteArray> identities;
+    QList<QVariantMap> changed;
+    QHash<quint64, int> appendedKeys;
+    qint64 offset = m_mapSize;
+
+    for (const QVariantMap &session : sessions) {
+        const QByteArray identity = sessionIdentity(session);
+        const QByteArray payload = QCborValue::fromVariant(session).toCbor();
+
+        // Different sessions with the same key are stored under the next free key.
+        // Sessions are reported again by the incremental sync, only store changes.
+        quint64 key = sessionKey(identity);
+        bool unchanged = false;
+        forever {
+            auto appended = appendedKeys.constFind(key);
+            if (appended != appendedKeys.constEnd()) {
+                if (identities.at(appended.value()) == identity)
+                    break;
+
+                key++;
+                continue;
+            }
+
+            auto existing = m_recordOffsets.constFind(key);
+            if (existing == m_recordOffsets.constEnd())
+                break;
+
+            const quint32 existingLength = qFromLittleEndian<quint32>(m_map + existing.value() + 4);
+            if (existingLength == static_cast<quint32>(payload.size())
+                && memcmp(m_map + existing.value() + s_recordHeaderSize, payload.constData(), payload.size()) == 0) {
+                unchanged = true;
+                break;
+            }
+
+            if (storedIdentity(existing.value()) == identity)
+                break;
+
+            key++;
+        }
+
+        if (unchanged)
+            continue;
+
+        IndexEntry entry;
+        entry.key = key;
+        entry.startTimestamp = session.value(QStringLiteral("startTimestamp")).toLongLong();
+        entry.endTimestamp = session.value(QStringLiteral("endTimestamp")).toLongLong();
+        entry.energy = session.value(QStringLiteral("sessionEnergy")).toDouble();
+        entry.carId = QUuid::fromString(session.value(QStringLiteral("carId")).toString());
+        entry.chargerId = QUuid::fromString(session.value(QStringLiteral("evChargerId")).toString());
+        entry.offset = offset;
+        entry.length = static_cast<quint32>(payload.size());
+
+        char header[s_recordHeaderSize];
+        memset(header, 0, s_recordHeaderSize);
+        qToLittleEndian<quint32>(s_recordMagic, header);
+        qToLittleEndian<quint32>(entry.length, header + 4);
+        qToLittleEndian<quint64>(entry.key, header + 8);
+        qToLittleEndian<qint64>(entry.startTimestamp, header + 16);
+        qToLittleEndian<qint64>(entry.endTimestamp, header + 24);
+        memcpy(header + 32, entry.carId.toRfc4122().constData(), 16);
+        memcpy(header + 48, entry.chargerId.toRfc4122().constData(), 16);
+        qToLittleEndian<quint64>(energyBits(entry.energy), header + 64);
+
+        data.append(header, s_recordHeaderSize);
+        data.append(payload);
+        offset += s_recordHeaderSize + payload.size();
+
+        // A session reported twice in the same batch replaces its earlier change
+        auto appended = appendedKeys.constFind(key);
+        if (appended != appendedKeys.constEnd()) {
+            changed[appended.value()] = session;
+        } else {
+            appendedKeys.insert(key, identities.count());
+            identities.append(identity);
+            changed.append(session);
+        }
+        entries.append(entry);
+    }
+
+    if (entries.isEmpty())
+        return 0;
+
+    if (!m_file.seek(m_mapSize) || m_file.write(data) != data.size() || !m_file.flush()) {
+        qCWarning(dcEvDashExperience()) << "Could not append to session store" << m_file.fileName() << m_file.errorString();
+        m_file.resize(m_mapSize);
+        return 0;
+    }
+
+    if (!remap())
+        return 0;
+
+    for (const IndexEntry &entry : qAsConst(entries)) {
+        auto existing = m_recordOffsets.constFind(entry.key);
+        if (existing != m_recordOffsets.constEnd())
+            removeIndexEntry(entry.key, existing.value());
+
+        insertIndexEntry(entry);
+    }
+
+    if (m_supersededBytes > s_compactionThreshold && m_supersededBytes > m_mapSize / 2)
+        compact();
+
+    if (changedSessions)
+        changedSessions->append(changed);
+
+    return changed.count();
+}
+
+QList<QVariantMap> EvDashSessionStore::sessions(const QStringList &carIds, qint64 startTimestamp, qint64 endTimestamp, const QStringList &chargerIds) const
+{
+    QList<QVariantMap> result;
+    if (!isOpen())
+        return result;
+
+    int first = 0;
+    int last = 0;
+    selectRange(startTimestamp, endTimestamp, &first, &last);
+
+    const QVector<char> carMatches = matchTable(carIds, m_carDictionary, m_carIds.count());
+    const QVector<char> chargerMatches = matchTable(chargerIds, m_chargerDictionary, m_chargerIds.count());
+    const char *carMatch = carMatches.constData();
+    const char *chargerMatch = chargerMatches.constData();
+    const quint32 *carIndexes = m_carIndexes.constData();
+    const quint32 *chargerIndexes = m_chargerIndexes.constData();
+
+    for (int row = first; row < last; row++) {
+        if (carMatch[carIndexes[row]] & chargerMatch[chargerIndexes[row]])
+            result.append(readRecord(row));
+    }
+
+    return result;
+}
+
+EvDashSessionStore::Summary EvDashSessionStore::summary(const QStringList &carIds, qint64 startTimestamp, qint64 endTimestamp, const QStringList &chargerIds) const
+{
+    Summary summary = {0, 0};
+    if (!isOpen())
+        return summary;
+
+    int first = 0;
+    int last = 0;
+    selectRange(startTimestamp, endTimestamp, &first, &last);
+
+    // Without filters the sum runs over the energy column only
+    const double *energies = m_energies.constData();
+    if (carIds.isEmpty() && chargerIds.isEmpty()) {
+        for (int row = first; row < last; row++)
+            summary.totalEnergy += energies[row];
+
+        summary.count = last - first;
+        return summary;
+    }
+
+    const QVector<char> carMatches = matchTable(carIds, m_carDictionary, m_carIds.count());
+    const QVector<char> chargerMatches = matchTable(chargerIds, m_chargerDictionary, m_chargerIds.count());
+    const char *carMatch = carMatches.constData();
+    const char *chargerMatch = chargerMatches.constData();
+    const quint32 *carIndexes = m_carIndexes.constData();
+    const quint32 *chargerIndexes = m_chargerIndexes.constData();
+
+    for (int row = first; row < last; row++) {
+        const int match = carMatch[carIndexes[row]] & chargerMatch[chargerIndexes[row]];
+        summary.count += match;
+        summary.totalEnergy += match ? energies[row] : 0;
+    }
+
+    return summary;
+}
+
+QList<QVariantMap> EvDashSessionStore::recentSessions(int count) const
+{
+    QList<QVariantMap> result;
+    if (!isOpen())
+        return result;
+
+    for (int row = m_endTimestamps.count() - 1; row >= 0 && result.count() < count; row--)
+        result.append(readRecord(row));
+
+    return result;
+}
+
+bool EvDashSessionStore::loadIndex()
+{
+    clearIndex();
+
+    qint64 offset = s_fileHeaderSize;
+    while (offset + s_recordHeaderSize <= m_mapSize) {
+        const uchar *header = m_map + offset;
+        const quint32 length = qFromLittleEndian<quint32>(header + 4);
+        if (qFromLittleEndian<quint32>(header) != s_recordMagic || offset + s_recordHeaderSize + length > m_mapSize)
+            break;
+
+        IndexEntry entry;
+        entry.length = length;
+        entry.key = qFromLittleEndian<quint64>(header + 8);
+        entry.startTimestamp = qFromLittleEndian<qint64>(header + 16);
+        entry.endTimestamp = qFromLittleEndian<qint64>(header + 24);
+        entry.carId = QUuid::fromRfc4122(QByteArray::fromRawData(reinterpret_cast<const char *>(header + 32), 16));
+        entry.chargerId = QUuid::fromRfc4122(QByteArray::fromRawData(reinterpret_cast<const char *>(header + 48), 16));
+        entry.energy = energyFromBits(qFromLittleEndian<quint64>(header + 64));
+        entry.offset = offset;
+
+        auto existing = m_recordOffsets.constFind(entry.key);
+        if (existing != m_recordOffsets.constEnd())
+            removeIndexEntry(entry.key, existing.value());
+
+        insertIndexEntry(entry);
+        offset += s_recordHeaderSize + length;
+    }
+
+    // Drop a record which has not been written completely
+    if (offset < m_mapSize) {
+        qCWarning(dcEvDashExperience()) << "Truncating incomplete record at the end of the session store" << m_file.fileName();
+        m_file.unmap(m_map);
+        m_map = nullptr;
+        if (!m_file.resize(offset))
+            return false;
+
+        return remap();
+    }
+
+    return true;
+}
+
+bool EvDashSessionStore::remap()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+
+    m_mapSize = m_file.size();
+    m_map = m_file.map(0, m_mapSize);
+    if (!m_map) {
+        qCWarning(dcEvDashExperience()) << "Could not map session store" << m_file.fileName() << m_file.errorString();
+        m_mapSize = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void EvDashSessionStore::clearIndex()
+{
+    m_endTimestamps.clear();
+    m_startTimestamps.clear();
+    m_energies.clear();
+    m_carIndexes.clear();
+    m_chargerIndexes.clear();
+    m_offsets.clear();
+    m_lengths.clear();
+    m_carIds.clear();
+    m_carDictionary.clear();
+    m_chargerIds.clear();
+    m_chargerDictionary.clear();
+    m_recordOffsets.clear();
+    m_supersededBytes = 0;
+}
+
+void EvDashSessionStore::insertIndexEntry(const IndexEntry &entry)
+{
+    // Sessions arrive mostly in order, appending is the common case
+    int row = m_endTimestamps.count();
+    if (!m_endTimestamps.isEmpty() && m_endTimestamps.last() > entry.endTimestamp)
+        row = std::upper_bound(m_endTimestamps.cbegin(), m_endTimestamps.cend(), entry.endTimestamp) - m_endTimestamps.cbegin();
+
+    m_endTimestamps.insert(row, entry.endTimestamp);
+    m_startTimestamps.insert(row, entry.startTimestamp);
+    m_energies.insert(row, entry.energy);
+    m_carIndexes.insert(row, dictionaryIndex(entry.carId, &m_carIds, &m_carDictionary));
+    m_chargerIndexes.insert(row, dictionaryIndex(entry.chargerId, &m_chargerIds, &m_chargerDictionary));
+    m_offsets.insert(row, entry.offset);
+    m_lengths.insert(row, entry.length);
+    m_recordOffsets.insert(entry.key, entry.offset);
+}
+
+void EvDashSessionStore::removeIndexEntry(quint64 key, qint64 offset)
+{
+    m_recordOffsets.remove(key);
+    m_supersededBytes += s_recordHeaderSize + qFromLittleEndian<quint32>(m_map + offset + 4);
+
+    // The row is among those with the end timestamp of the record
+    const qint64 endTimestamp = qFromLittleEndian<qint64>(m_map + offset + 24);
+    auto range = std::equal_range(m_endTimestamps.cbegin(), m_endTimestamps.cend(), endTimestamp);
+    for (int row = range.first - m_endTimestamps.cbegin(); row < range.second - m_endTimestamps.cbegin(); row++) {
+        if (m_offsets.at(row) != offset)
+            continue;
+
+        m_endTimestamps.remove(row);
+        m_startTimestamps.remove(row);
+        m_energies.remove(row);
+        m_carIndexes.remove(row);
+        m_chargerIndexes.remove(row);
+        m_offsets.remove(row);
+        m_lengths.remove(row);
+        return;
+    }
+}
+
+QVariantMap EvDashSessionStore::readRecord(int row) const
+{
+    const QByteArray payload = QByteArray::fromRawData(reinterpret_cast<const char *>(m_map + m_offsets.at(row) + s_recordHeaderSize), m_lengths.at(row));
+    return QCborValue::fromCbor(payload).toVariant().toMap();
+}
+
+QByteArray EvDashSessionStore::storedIdentity(qint64 offset) const
+{
+    const quint32 length = qFromLittleEndian<quint32>(m_map + offset + 4);
+    const QByteArray payload = QByteArray::fromRawData(reinterpret_cast<const char *>(m_map + offset + s_recordHeaderSize), length);
+    return sessionIdentity(QCborValue::fromCbor(payload).toVariant().toMap());
+}
+
+bool EvDashSessionStore::compact()
+{
+    // The current records are copied in index order, their keys are kept
+    QSaveFile file(m_file.fileName());
+    if (!file.open(QFile::WriteOnly)) {
+        qCWarning(dcEvDashExperience()) << "Could not compact session store" << m_file.fileName() << file.errorString();
+        return false;
+    }
+
+    file.write(s_fileMagic);
+    for (int row = 0; row < m_offsets.count(); row++)
+        file.write(reinterpret_cast<const char *>(m_map + m_offsets.at(row)), s_recordHeaderSize + m_lengths.at(row));
+
+    const qint64 previousSize = m_mapSize;
+    close();
+    if (!file.commit())
+        qCWarning(dcEvDashExperience()) << "Could not compact session store" << m_file.fileName() << file.errorString();
+
+    if (!open())
+        return false;
+
+    qCDebug(dcEvDashExperience()) << "Compacted session store" << m_file.fileName() << "from" << previousSize << "to" << m_mapSize << "bytes";
+    return true;
+}
+
+void EvDashSessionStore::selectRange(qint64 startTimestamp, qint64 endTimestamp, int *first, int *last) const
+{
+    auto begin = m_endTimestamps.cbegin();
+    auto end = m_endTimestamps.cend();
+    if (startTimestamp > 0)
+        begin = std::lower_bound(begin, end, startTimestamp);
+    if (endTimestamp > 0)
+        end = std::upper_bound(begin, end, endTimestamp);
+
+    *first = begin - m_endTimestamps.cbegin();
+    *last = qMax(*first, static_cast<int>(end - m_endTimestamps.cbegin()));
+}
+
+QVector<char> EvDashSessionStore::matchTable(const QStringList &ids, const QHash<QUuid, quint32> &dictionary, int size)
+{
+    // One flag per dictionary entry, the filter loops only look up the row's index
+    QVector<char> table(size, ids.isEmpty() ? 1 : 0);
+    for (const QString &id : ids) {
+        auto it = dictionary.constFind(QUuid::fromString(id));
+        if (it != dictionary.constEnd())
+            table[it.value()] = 1;
+    }
+
+    return table;
+}
+
+quint32 EvDashSessionStore::dictionaryIndex(const QUuid &id, QVector<QUuid> *ids, QHash<QUuid, quint32> *dictionary)
+{
+    auto it = dictionary->constFind(id);
+    if (it != dictionary->constEnd())
+        return it.value();
+
+    const quint32 index = static_cast<quint32>(ids->count());
+    ids->append(id);
+    dictionary->insert(id, index);
+    return index;
+}
+
+QByteArray EvDashSessionStore::sessionIdentity(const QVariantMap &session)
+{
+    // The session id, or car and start time if the service does not provide one
+    if (session.contains(QStringLiteral("sessionId")))
+        return "id:" + session.value(QStringLiteral("sessionId")).toString().toUtf8();
+
+    return session.value(QStringLiteral("carId")).toString().toUtf8() + '/' + QByteArray::number(session.value(QStringLiteral("startTimestamp")).toLongLong());
+}
+
+quint64 EvDashSessionStore::sessionKey(const QByteArray &identity)
+{
+    // FNV-1a of the identity, collisions are resolved by comparing the stored identity
+    quint64 hash = 14695981039346656037ULL;
+    for (const char c : identity) {
+        hash ^= static_cast<uchar>(c);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
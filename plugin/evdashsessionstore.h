@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef EVDASHSESSIONSTORE_H
+#define EVDASHSESSIONSTORE_H
+
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QUuid>
+#include <QVariantMap>
+#include <QVector>
+
+// Local copy of the charging session history. Sessions are appended to a
+// memory mapped file, newer records of the same session supersede older
+// ones. An in memory index answers queries without touching the records
+// which are not part of the result. It is stored column wise and sorted by
+// end timestamp, car and charger ids are dictionary encoded. The file
+// survives restarts, so only sessions ending around or after the last known
+// one have to be fetched from the charging sessions service. Once most of the
+// file consists of superseded records it is rewritten with the current ones.
+class EvDashSessionStore
+{
+public:
+    struct Summary
+    {
+        int count;
+        double totalEnergy;
+    };
+
+    explicit EvDashSessionStore(const QString &fileName);
+    ~EvDashSessionStore();
+
+    EvDashSessionStore(const EvDashSessionStore &) = delete;
+    EvDashSessionStore &operator=(const EvDashSessionStore &) = delete;
+
+    bool open();
+    void close();
+    bool isOpen() const;
+
+    QString fileName() const;
+    int count() const;
+    qint64 newestEndTimestamp() const;
+
+    // Returns the number of new or changed sessions, which are added to changedSessions if given
+    int append(const QList<QVariantMap> &sessions, QList<QVariantMap> *changedSessions = nullptr);
+
+    // Sessions ending within [startTimestamp, endTimestamp], 0 means unbounded.
+    // Empty car or charger lists match all cars or chargers.
+    QList<QVariantMap> sessions(const QStringList &carIds = QStringList(), qint64 startTimestamp = 0, qint64 endTimestamp = 0, const QStringList &chargerIds = QStringList()) const;
+    Summary summary(const QStringList &carIds = QStringList(), qint64 startTimestamp = 0, qint64 endTimestamp = 0, const QStringList &chargerIds = QStringList()) const;
+
+    // The sessions which ended last, newest first
+    QList<QVariantMap> recentSessions(int count) const;
+
+private:
+    struct IndexEntry
+    {
+        qint64 endTimestamp = 0;
+        qint64 startTimestamp = 0;
+        double energy = 0;
+        QUuid carId;
+        QUuid chargerId;
+        quint64 key = 0;
+        qint64 offset = 0;
+        quint32 length = 0;
+    };
+
+    static constexpr int s_fileHeaderSize = 8;
+    static constexpr int s_recordHeaderSize = 80;
+
+    QFile m_file;
+    uchar *m_map = nullptr;
+    qint64 m_mapSize = 0;
+
+    // Index columns, row i of each column belongs to the same session. Rows are
+    // sorted by end timestamp, superseded records are not indexed.
+    QVector<qint64> m_endTimestamps;
+    QVector<qint64> m_startTimestamps;
+    QVector<double> m_energies;
+    QVector<quint32> m_carIndexes;
+    QVector<quint32> m_chargerIndexes;
+    QVector<qint64> m_offsets;
+    QVector<quint32> m_lengths;
+
+    // Dictionaries of the car and charger columns, entries are never removed
+    QVector<QUuid> m_carIds;
+    QHash<QUuid, quint32> m_carDictionary;
+    QVector<QUuid> m_chargerIds;
+    QHash<QUuid, quint32> m_chargerDictionary;
+
+    QHash<quint64, qint64> m_recordOffsets;
+
+    // Bytes of records which have been superseded by newer ones
+    qint64 m_supersededBytes = 0;
+
+    bool loadIndex();
+    bool remap();
+    void clearIndex();
+    void insertIndexEntry(const IndexEntry &entry);
+    void removeIndexEntry(quint64 key, qint64 offset);
+    QVariantMap readRecord(int row) const;
+    QByteArray storedIdentity(qint64 offset) const;
+    bool compact();
+
+    // Row range for the time range and match tables for the dictionaries
+    void selectRange(qint64 startTimestamp, qint64 endTimestamp, int *first, int *last) const;
+    static QVector<char> matchTable(const QStringList &ids, const QHash<QUuid, quint32> &dictionary, int size);
+
+    static quint32 dictionaryIndex(const QUuid &id, QVector<QUuid> *ids, QHash<QUuid, quint32> *dictionary);
+    static QByteArray sessionIdentity(const QVariantMap &session);
+    static quint64 sessionKey(const QByteArray &identity);
+};
+
+#endif // EVDASHSESSIONSTORE_H
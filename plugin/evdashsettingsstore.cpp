@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "evdashsettingsstore.h"
+
+#include <QEvent>
+#include <QTimer>
+
+#include <QLoggingCategory>
+Q_DECLARE_LOGGING_CATEGORY(dcEvDashExperience)
+
+EvDashSettingsStore::EvDashSettingsStore(QObject *parent)
+    : QObject{parent}
+{
+    // Write to a temporary file and rename it over evdash.conf
+    m_settings.setAtomicSyncRequired(true);
+
+    // QSettings flushes on its own with the next event loop iteration, commits are timed here instead
+    m_settings.installEventFilter(this);
+
+    m_settings.beginGroup("Settings");
+    const int commitDelay = qBound(0, m_settings.value("commitDelay", 1000).toInt(), 60000);
+    m_settings.endGroup();
+
+    m_commitTimer = new QTimer(this);
+    m_commitTimer->setSingleShot(true);
+    m_commitTimer->setInterval(commitDelay);
+    connect(m_commitTimer, &QTimer::timeout, this, &EvDashSettingsStore::commit);
+}
+
+EvDashSettingsStore::~EvDashSettingsStore()
+{
+    commit();
+}
+
+QVariant EvDashSettingsStore::value(const QString &key, const QVariant &defaultValue) const
+{
+    return m_settings.value(key, defaultValue);
+}
+
+void EvDashSettingsStore::setValue(const QString &key, const QVariant &value)
+{
+    m_settings.setValue(key, value);
+    scheduleCommit();
+}
+
+void EvDashSettingsStore::remove(const QString &key)
+{
+    m_settings.remove(key);
+    scheduleCommit();
+}
+
+bool EvDashSettingsStore::hasPendingChanges() const
+{
+    return m_pendingChanges;
+}
+
+quint64 EvDashSettingsStore::commits() const
+{
+    return m_commits;
+}
+
+bool EvDashSettingsStore::commit()
+{
+    m_commitTimer->stop();
+    if (!m_pendingChanges)
+        return true;
+
+    m_settings.sync();
+    if (m_settings.status() != QSettings::NoError) {
+        qCWarning(dcEvDashExperience()) << "Could not write settings to" << m_settings.fileName() << m_settings.status();
+        return false;
+    }
+
+    m_pendingChanges = false;
+    m_commits++;
+    return true;
+}
+
+bool EvDashSettingsStore::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == &m_settings && event->type() == QEvent::UpdateRequest)
+        return true;
+
+    return QObject::eventFilter(watched, event);
+}
+
+void EvDashSettingsStore::scheduleCommit()
+{
+    m_pendingChanges = true;
+    if (!m_commitTimer->isActive())
+        m_commitTimer->start();
+}
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef EVDASHSETTINGSSTORE_H
+#define EVDASHSETTINGSSTORE_H
+
+#include <QObject>
+#include <QVariant>
+
+#include "evdashsettings.h"
+
+class QTimer;
+
+// Long lived writer for evdash.conf. Changes are kept in memory and written
+// together once the commit delay has passed, or right away with commit().
+// Each commit replaces the file atomically, a crash never leaves a partially
+// written configuration behind.
+class EvDashSettingsStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EvDashSettingsStore(QObject *parent = nullptr);
+    ~EvDashSettingsStore() override;
+
+    QVariant value(const QString &key, const QVariant &defaultValue = QVariant()) const;
+    void setValue(const QString &key, const QVariant &value);
+    void remove(const QString &key);
+
+    bool hasPendingChanges() const;
+    quint64 commits() const;
+
+public slots:
+    bool commit();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    EvDashSettings m_settings;
+    QTimer *m_commitTimer = nullptr;
+    bool m_pendingChanges = false;
+    quint64 m_commits = 0;
+
+    void scheduleCommit();
+};
+
+#endif // EVDASHSETTINGSSTORE_H
@@ -0,0 +1,294 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "evdashstatistics.h"
+
+#include <QVariantList>
+
+const QVector<double> EvDashStatistics::s_histogramBuckets = {0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1, 5};
+
+static QByteArray formatValue(double value)
+{
+    return QByteArray::number(value, 'g', 15);
+}
+
+static QByteArray typeName(EvDashStatistics::MetricType type)
+{
+    switch (type) {
+    case EvDashStatistics::MetricTypeCounter:
+        return "counter";
+    case EvDashStatistics::MetricTypeGauge:
+        return "gauge";
+    case EvDashStatistics::MetricTypeHistogram:
+        return "histogram";
+    }
+
+    return "untyped";
+}
+
+static QByteArray escapeLabelValue(const QString &value)
+{
+    QByteArray escaped = value.toUtf8();
+    escaped.replace('\\', "\\\\");
+    escaped.replace('"', "\\\"");
+    escaped.replace('\n', "\\n");
+    return escaped;
+}
+
+EvDashStatistics::EvDashStatistics(QObject *parent)
+    : QObject{parent}
+{
+    // WebSocket API
+    registerMetric("evdash_websocket_clients", MetricTypeGauge, "Number of connected WebSocket clients.");
+    registerMetric("evdash_websocket_authenticated_clients", MetricTypeGauge, "Number of authenticated WebSocket clients.");
+    registerMetric("evdash_websocket_workers", MetricTypeGauge, "Number of WebSocket worker threads.");
+    registerMetric("evdash_websocket_send_queue_depth", MetricTypeGauge, "Frames waiting to be written by the WebSocket worker threads.");
+    registerMetric("evdash_websocket_rate_classes", MetricTypeGauge, "Distinct update intervals requested by rate limited clients.");
+    registerMetric("evdash_notifications_sent_total", MetricTypeCounter, "Notifications delivered to WebSocket clients.", "event");
+    registerMetric("evdash_bytes_sent_total", MetricTypeCounter, "Bytes queued for all WebSocket clients.");
+    registerMetric("evdash_client_bytes_sent_total", MetricTypeCounter, "Bytes queued per connected WebSocket client.", "client");
+    registerMetric("evdash_request_duration_seconds", MetricTypeHistogram, "Time from receiving a WebSocket request until the reply has been queued.", "action");
+    registerMetric("evdash_pending_session_requests", MetricTypeGauge, "Charging session requests waiting for the DBus reply.");
+    registerMetric("evdash_replay_log_entries", MetricTypeGauge, "Notifications kept for clients resuming after a reconnect.");
+    registerMetric("evdash_resume_requests_total", MetricTypeCounter, "Resumes on authenticate by outcome, replayed from the log or answered with a snapshot.", "result");
+
+    // Encoding
+    registerMetric("evdash_pack_duration_seconds", MetricTypeHistogram, "Time spent packing things into JSON objects.", "type");
+    registerMetric("evdash_serialize_duration_seconds", MetricTypeHistogram, "Time spent serializing replies and notifications.", "kind");
+    registerMetric("evdash_snapshot_builds_total", MetricTypeCounter, "Rebuilds of the cached GetSnapshot payload.");
+    registerMetric("evdash_deadband_suppressed_total", MetricTypeCounter, "Charger value changes within the configured deadband, not sent to clients.", "field");
+
+    // Backends
+    registerMetric("evdash_dbus_call_duration_seconds", MetricTypeHistogram, "Duration of DBus calls to the energy services.", "call");
+    registerMetric("evdash_dbus_call_errors_total", MetricTypeCounter, "Failed DBus calls to the energy services.", "call");
+    registerMetric("evdash_logengine_fetch_duration_seconds", MetricTypeHistogram, "Duration of log entry fetches from the nymea log engine.");
+    registerMetric("evdash_session_store_sessions", MetricTypeGauge, "Charging sessions kept in the local session store.");
+    registerMetric("evdash_settings_commits_total", MetricTypeCounter, "Writes of the EV Dash configuration file.");
+
+    // TLS
+    registerMetric("evdash_tls_handshakes_total", MetricTypeCounter, "Completed TLS handshakes on the WebSocket server.", "type");
+
+    // Web server resource
+    registerMetric("evdash_http_request_duration_seconds", MetricTypeHistogram, "Time spent processing HTTP requests.", "route");
+    registerMetric("evdash_http_rejected_attempts_total", MetricTypeCounter, "Login and token refresh attempts rejected by the throttle.", "route");
+}
+
+void EvDashStatistics::incrementCounter(const QString &name, const QString &label, double value)
+{
+    Metric *counter = metric(name, MetricTypeCounter);
+    if (!counter)
+        return;
+
+    addLabel(counter, label);
+
+    counter->values[label] += value;
+}
+
+void EvDashStatistics::setGauge(const QString &name, const QString &label, double value)
+{
+    Metric *gauge = metric(name, MetricTypeGauge);
+    if (!gauge)
+        return;
+
+    addLabel(gauge, label);
+
+    gauge->values[label] = value;
+}
+
+void EvDashStatistics::observeDuration(const QString &name, const QString &label, qint64 nanoseconds)
+{
+    Metric *histogram = metric(name, MetricTypeHistogram);
+    if (!histogram)
+        return;
+
+    addLabel(histogram, label);
+
+    Histogram &data = histogram->histograms[label];
+    if (data.bucketCounts.isEmpty())
+        data.bucketCounts.fill(0, s_histogramBuckets.count());
+
+    const double seconds = nanoseconds / 1e9;
+    for (int i = 0; i < s_histogramBuckets.count(); i++) {
+        if (seconds <= s_histogramBuckets.at(i)) {
+            data.bucketCounts[i]++;
+            break;
+        }
+    }
+
+    data.count++;
+    data.sum += seconds;
+    data.max = qMax(data.max, seconds);
+}
+
+void EvDashStatistics::setValueProvider(const QString &name, const QString &label, std::function<double()> provider)
+{
+    if (!m_metricIndex.contains(name))
+        return;
+
+    Metric &target = m_metrics[m_metricIndex.value(name)];
+    if (target.type == MetricTypeHistogram)
+        return;
+
+    addLabel(&target, label);
+
+    target.providers.insert(label, provider);
+}
+
+void EvDashStatistics::removeLabel(const QString &name, const QString &label)
+{
+    if (!m_metricIndex.contains(name))
+        return;
+
+    Metric &target = m_metrics[m_metricIndex.value(name)];
+    if (target.labelSet.remove(label))
+        target.labels.removeOne(label);
+    target.values.remove(label);
+    target.histograms.remove(label);
+    target.providers.remove(label);
+}
+
+QVariantMap EvDashStatistics::toVariantMap() const
+{
+    QVariantMap statistics;
+    for (const Metric &metric : m_metrics) {
+        QVariantList samples;
+        for (const QString &label : metric.labels) {
+            QVariantMap sample;
+            if (!metric.labelName.isEmpty())
+                sample.insert(metric.labelName, label);
+
+            if (metric.type == MetricTypeHistogram) {
+                const Histogram histogram = metric.histograms.value(label);
+                sample.insert("count", histogram.count);
+                sample.insert("sum", histogram.sum);
+                sample.insert("max", histogram.max);
+                sample.insert("average", histogram.count > 0 ? histogram.sum / histogram.count : 0);
+
+                QVariantList buckets;
+                quint64 cumulative = 0;
+                for (int i = 0; i < s_histogramBuckets.count(); i++) {
+                    cumulative += histogram.bucketCounts.value(i);
+                    buckets.append(QVariantMap{{"le", s_histogramBuckets.at(i)}, {"count", cumulative}});
+                }
+                sample.insert("buckets", buckets);
+            } else {
+                sample.insert("value", currentValue(metric, label));
+            }
+
+            samples.append(sample);
+        }
+
+        QVariantMap metricMap;
+        metricMap.insert("type", QString::fromLatin1(typeName(metric.type)));
+        metricMap.insert("help", metric.help);
+        metricMap.insert("samples", samples);
+        statistics.insert(metric.name, metricMap);
+    }
+
+    return statistics;
+}
+
+QByteArray EvDashStatistics::toPrometheusText() const
+{
+    QByteArray text;
+    for (const Metric &metric : m_metrics) {
+        const QByteArray name = metric.name.toUtf8();
+        text += "# HELP " + name + ' ' + metric.help.toUtf8() + '\n';
+        text += "# TYPE " + name + ' ' + typeName(metric.type) + '\n';
+
+        for (const QString &label : metric.labels) {
+            QByteArray labelPair;
+            if (!metric.labelName.isEmpty())
+                labelPair = metric.labelName.toUtf8() + "=\"" + escapeLabelValue(label) + '"';
+
+            if (metric.type != MetricTypeHistogram) {
+                text += name;
+                if (!labelPair.isEmpty())
+                    text += '{' + labelPair + '}';
+
+                text += ' ' + formatValue(currentValue(metric, label)) + '\n';
+                continue;
+            }
+
+            const Histogram histogram = metric.histograms.value(label);
+            const QByteArray bucketPrefix = labelPair.isEmpty() ? QByteArray() : labelPair + ',';
+            quint64 cumulative = 0;
+            for (int i = 0; i < s_histogramBuckets.count(); i++) {
+                cumulative += histogram.bucketCounts.value(i);
+                text += name + "_bucket{" + bucketPrefix + "le=\"" + formatValue(s_histogramBuckets.at(i)) + "\"} " + QByteArray::number(cumulative) + '\n';
+            }
+            text += name + "_bucket{" + bucketPrefix + "le=\"+Inf\"} " + QByteArray::number(histogram.count) + '\n';
+
+            const QByteArray labelSet = labelPair.isEmpty() ? QByteArray() : '{' + labelPair + '}';
+            text += name + "_sum" + labelSet + ' ' + formatValue(histogram.sum) + '\n';
+            text += name + "_count" + labelSet + ' ' + QByteArray::number(histogram.count) + '\n';
+        }
+    }
+
+    return text;
+}
+
+void EvDashStatistics::registerMetric(const QString &name, MetricType type, const QString &help, const QString &labelName)
+{
+    Metric metric;
+    metric.name = name;
+    metric.type = type;
+    metric.help = help;
+    metric.labelName = labelName;
+
+    m_metricIndex.insert(name, m_metrics.count());
+    m_metrics.append(metric);
+}
+
+EvDashStatistics::Metric *EvDashStatistics::metric(const QString &name, MetricType type)
+{
+    auto it = m_metricIndex.constFind(name);
+    if (it == m_metricIndex.constEnd())
+        return nullptr;
+
+    Metric *metric = &m_metrics[it.value()];
+    if (metric->type != type)
+        return nullptr;
+
+    return metric;
+}
+
+void EvDashStatistics::addLabel(Metric *metric, const QString &label)
+{
+    if (metric->labelSet.contains(label))
+        return;
+
+    metric->labelSet.insert(label);
+    metric->labels.append(label);
+}
+
+double EvDashStatistics::currentValue(const Metric &metric, const QString &label) const
+{
+    auto provider = metric.providers.constFind(label);
+    if (provider != metric.providers.constEnd() && provider.value())
+        return provider.value()();
+
+    return metric.values.value(label);
+}
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef EVDASHSTATISTICS_H
+#define EVDASHSTATISTICS_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+
+#include <functional>
+
+// Runtime counters, gauges and latency histograms of the EV Dash experience.
+// All metrics are registered up front in the constructor, recording a value
+// for an unknown metric is ignored. Each metric has at most one label.
+// Not thread safe, only to be used from the nymead main thread.
+class EvDashStatistics : public QObject
+{
+    Q_OBJECT
+public:
+    enum MetricType { MetricTypeCounter, MetricTypeGauge, MetricTypeHistogram };
+    Q_ENUM(MetricType)
+
+    explicit EvDashStatistics(QObject *parent = nullptr);
+
+    void incrementCounter(const QString &name, const QString &label = QString(), double value = 1);
+    void setGauge(const QString &name, const QString &label, double value);
+    void observeDuration(const QString &name, const QString &label, qint64 nanoseconds);
+
+    // Evaluated whenever a snapshot is taken
+    void setValueProvider(const QString &name, const QString &label, std::function<double()> provider);
+
+    void removeLabel(const QString &name, const QString &label);
+
+    QVariantMap toVariantMap() const;
+    QByteArray toPrometheusText() const;
+
+private:
+    struct Histogram
+    {
+        QVector<quint64> bucketCounts;
+        quint64 count = 0;
+        double sum = 0;
+        double max = 0;
+    };
+
+    struct Metric
+    {
+        QString name;
+        MetricType type = MetricTypeCounter;
+        QString help;
+        QString labelName;
+        // Labels in order of appearance, the set answers lookups on the hot paths
+        QStringList labels;
+        QSet<QString> labelSet;
+        QHash<QString, double> values;
+        QHash<QString, Histogram> histograms;
+        QHash<QString, std::function<double()>> providers;
+    };
+
+    // Upper bounds in seconds
+    static const QVector<double> s_histogramBuckets;
+
+    QVector<Metric> m_metrics;
+    QHash<QString, int> m_metricIndex;
+
+    void registerMetric(const QString &name, MetricType type, const QString &help, const QString &labelName = QString());
+    Metric *metric(const QString &name, MetricType type);
+    static void addLabel(Metric *metric, const QString &label);
+    double currentValue(const Metric &metric, const QString &label) const;
+};
+
+#endif // EVDASHSTATISTICS_H
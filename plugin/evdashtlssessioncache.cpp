@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "evdashtlssessioncache.h"
+
+#include <QSslSocket>
+#include <QUuid>
+
+#include <openssl/opensslv.h>
+#include <openssl/rand.h>
+#include <openssl/ssl.h>
+
+#include <QLoggingCategory>
+Q_DECLARE_LOGGING_CATEGORY(dcEvDashExperience)
+
+static int cacheExDataIndex()
+{
+    static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+static EvDashTlsSessionCache *cacheForContext(SSL_CTX *context)
+{
+    return static_cast<EvDashTlsSessionCache *>(SSL_CTX_get_ex_data(context, cacheExDataIndex()));
+}
+
+static int onNewSession(SSL *ssl, SSL_SESSION *session)
+{
+    EvDashTlsSessionCache *cache = cacheForContext(SSL_get_SSL_CTX(ssl));
+    if (!cache)
+        return 0;
+
+    unsigned int idLength = 0;
+    const unsigned char *id = SSL_SESSION_get_id(session, &idLength);
+
+    const int length = i2d_SSL_SESSION(session, nullptr);
+    if (length <= 0)
+        return 0;
+
+    QByteArray sessionData(length, Qt::Uninitialized);
+    unsigned char *data = reinterpret_cast<unsigned char *>(sessionData.data());
+    i2d_SSL_SESSION(session, &data);
+
+    cache->storeSession(QByteArray(reinterpret_cast<const char *>(id), static_cast<int>(idLength)), sessionData);
+
+    // We did not keep a reference to the session
+    return 0;
+}
+
+static SSL_SESSION *onGetSession(SSL *ssl, const unsigned char *id, int idLength, int *copy)
+{
+    *copy = 0;
+
+    EvDashTlsSessionCache *cache = cacheForContext(SSL_get_SSL_CTX(ssl));
+    if (!cache)
+        return nullptr;
+
+    const QByteArray sessionData = cache->lookupSession(QByteArray(reinterpret_cast<const char *>(id), idLength));
+    if (sessionData.isEmpty())
+        return nullptr;
+
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(sessionData.constData());
+    return d2i_SSL_SESSION(nullptr, &data, sessionData.length());
+}
+
+static void onRemoveSession(SSL_CTX *context, SSL_SESSION *session)
+{
+    EvDashTlsSessionCache *cache = cacheForContext(context);
+    if (!cache)
+        return;
+
+    unsigned int idLength = 0;
+    const unsigned char *id = SSL_SESSION_get_id(session, &idLength);
+    cache->removeSession(QByteArray(reinterpret_cast<const char *>(id), static_cast<int>(idLength)));
+}
+
+EvDashTlsSessionCache::EvDashTlsSessionCache(QObject *parent)
+    : QObject{parent}
+{
+    // Random ticket keys for the lifetime of this process. The required size depends on the OpenSSL version.
+    SSL_CTX *context = SSL_CTX_new(TLS_server_method());
+    if (context) {
+        const long keyLength = SSL_CTX_get_tlsext_ticket_keys(context, nullptr, 0);
+        SSL_CTX_free(context);
+
+        if (keyLength > 0) {
+            m_ticketKeys.resize(static_cast<int>(keyLength));
+            if (RAND_bytes(reinterpret_cast<unsigned char *>(m_ticketKeys.data()), m_ticketKeys.size()) != 1) {
+                qCWarning(dcEvDashExperience()) << "Could not generate TLS session ticket keys. Ticket resumption disabled.";
+                m_ticketKeys.clear();
+            }
+        }
+    }
+
+    m_sessionIdContext = QUuid::createUuid().toRfc4122();
+}
+
+bool EvDashTlsSessionCache::isSupported()
+{
+    // The native handle is only of use if Qt talks to the same OpenSSL we have been built against
+#if QT_VERSION >= QT_VERSION_CHECK(6, 1, 0)
+    if (QSslSocket::activeBackend() != QStringLiteral("openssl"))
+        return false;
+#endif
+
+    return QSslSocket::supportsSsl() && (QSslSocket::sslLibraryVersionNumber() >> 28) == (OPENSSL_VERSION_NUMBER >> 28);
+}
+
+void EvDashTlsSessionCache::attach(QSslSocket *socket)
+{
+    SSL *ssl = static_cast<SSL *>(socket->sslHandle());
+    if (!ssl) {
+        qCDebug(dcEvDashExperience()) << "No native TLS handle available, session resumption disabled for this connection.";
+        return;
+    }
+
+    SSL_CTX *context = SSL_get_SSL_CTX(ssl);
+    SSL_CTX_set_ex_data(context, cacheExDataIndex(), this);
+    SSL_CTX_set_timeout(context, m_sessionLifetime.loadRelaxed());
+
+    if (!m_ticketKeys.isEmpty())
+        SSL_CTX_set_tlsext_ticket_keys(context, m_ticketKeys.data(), m_ticketKeys.size());
+
+    SSL_CTX_set_session_id_context(context, reinterpret_cast<const unsigned char *>(m_sessionIdContext.constData()), m_sessionIdContext.size());
+    SSL_set_session_id_context(ssl, reinterpret_cast<const unsigned char *>(m_sessionIdContext.constData()), m_sessionIdContext.size());
+    SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+    SSL_CTX_sess_set_new_cb(context, onNewSession);
+    SSL_CTX_sess_set_get_cb(context, onGetSession);
+    SSL_CTX_sess_set_remove_cb(context, onRemoveSession);
+
+    // Evaluated in the thread of the socket
+    connect(socket, &QSslSocket::encrypted, socket, [this, socket]() {
+        SSL *ssl = static_cast<SSL *>(socket->sslHandle());
+        if (ssl && SSL_session_reused(ssl)) {
+            m_resumedHandshakes++;
+        } else {
+            m_fullHandshakes++;
+        }
+    });
+}
+
+int EvDashTlsSessionCache::sessionLifetime() const
+{
+    return m_sessionLifetime.loadRelaxed();
+}
+
+void EvDashTlsSessionCache::setSessionLifetime(int seconds)
+{
+    m_sessionLifetime.storeRelaxed(seconds);
+}
+
+quint64 EvDashTlsSessionCache::fullHandshakes() const
+{
+    return m_fullHandshakes.loadRelaxed();
+}
+
+quint64 EvDashTlsSessionCache::resumedHandshakes() const
+{
+    return m_resumedHandshakes.loadRelaxed();
+}
+
+void EvDashTlsSessionCache::storeSession(const QByteArray &sessionId, const QByteArray &sessionData)
+{
+    QMutexLocker locker(&m_sessionsMutex);
+    if (!m_sessions.contains(sessionId))
+        m_sessionOrder.append(sessionId);
+
+    m_sessions.insert(sessionId, sessionData);
+
+    while (m_sessionOrder.count() > s_maxSessions)
+        m_sessions.remove(m_sessionOrder.takeFirst());
+}
+
+QByteArray EvDashTlsSessionCache::lookupSession(const QByteArray &sessionId) const
+{
+    QMutexLocker locker(&m_sessionsMutex);
+    return m_sessions.value(sessionId);
+}
+
+void EvDashTlsSessionCache::removeSession(const QByteArray &sessionId)
+{
+    QMutexLocker locker(&m_sessionsMutex);
+    if (m_sessions.remove(sessionId) > 0)
+        m_sessionOrder.removeOne(sessionId);
+}
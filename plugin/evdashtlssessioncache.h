@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef EVDASHTLSSESSIONCACHE_H
+#define EVDASHTLSSESSIONCACHE_H
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+
+class QSslSocket;
+
+// Shares TLS session state between all server sockets. Qt creates a new SSL
+// context for every server socket, so neither the OpenSSL internal session
+// cache nor the session ticket keys would survive from one connection to the
+// next. This cache installs common ticket keys and an external session cache
+// on each socket right after the server handshake has been started.
+// Sockets may live in different threads, all methods are thread safe.
+class EvDashTlsSessionCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EvDashTlsSessionCache(QObject *parent = nullptr);
+
+    static bool isSupported();
+
+    void attach(QSslSocket *socket);
+
+    int sessionLifetime() const;
+    void setSessionLifetime(int seconds);
+
+    quint64 fullHandshakes() const;
+    quint64 resumedHandshakes() const;
+
+    // OpenSSL callbacks, public for the C trampolines only
+    void storeSession(const QByteArray &sessionId, const QByteArray &sessionData);
+    QByteArray lookupSession(const QByteArray &sessionId) const;
+    void removeSession(const QByteArray &sessionId);
+
+private:
+    static constexpr int s_maxSessions = 512;
+
+    QByteArray m_ticketKeys;
+    QByteArray m_sessionIdContext;
+    QAtomicInt m_sessionLifetime{3600};
+
+    mutable QMutex m_sessionsMutex;
+    QHash<QByteArray, QByteArray> m_sessions;
+    QList<QByteArray> m_sessionOrder;
+
+    QAtomicInteger<quint64> m_fullHandshakes{0};
+    QAtomicInteger<quint64> m_resumedHandshakes{0};
+};
+
+#endif // EVDASHTLSSESSIONCACHE_H
@@ -0,0 +1,222 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "evdashtracer.h"
+#include "evdashsettings.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTimer>
+
+#include <chrono>
+
+#include <QLoggingCategory>
+Q_DECLARE_LOGGING_CATEGORY(dcEvDashExperience)
+
+EvDashTracer::EvDashTracer(QObject *parent)
+    : QObject{parent}
+{
+    EvDashSettings settings;
+    settings.beginGroup("Tracing");
+    m_enabled.storeRelease(settings.value("enabled", false).toBool() ? 1 : 0);
+    m_directory = settings.value("directory", QDir::tempPath() + "/evdash-traces").toString();
+    m_maxFileSize = qMax<qint64>(64 * 1024, settings.value("maxFileSize", m_maxFileSize).toLongLong());
+    m_maxFiles = qMax(1, settings.value("maxFiles", m_maxFiles).toInt());
+    settings.endGroup();
+
+    if (!enabled())
+        return;
+
+    if (!QDir().mkpath(m_directory) || !openFile()) {
+        qCWarning(dcEvDashExperience()) << "Could not open trace file in" << m_directory << ". Tracing disabled.";
+        m_enabled.storeRelease(0);
+        return;
+    }
+
+    qCInfo(dcEvDashExperience()) << "Writing request traces to" << m_file.fileName();
+
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setInterval(1000);
+    connect(m_flushTimer, &QTimer::timeout, this, &EvDashTracer::flush);
+    m_flushTimer->start();
+}
+
+EvDashTracer::~EvDashTracer()
+{
+    if (!enabled())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    writeBuffer();
+    closeFile();
+}
+
+bool EvDashTracer::enabled() const
+{
+    return m_enabled.loadAcquire() != 0;
+}
+
+qint64 EvDashTracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QString EvDashTracer::requestTraceId(quint64 clientId, const QString &requestId)
+{
+    return QStringLiteral("c%1-%2").arg(clientId).arg(requestId);
+}
+
+void EvDashTracer::addSpan(const QString &traceId, const QString &name, qint64 start, qint64 end, const QVariantMap &args)
+{
+    if (!enabled())
+        return;
+
+    QJsonObject event;
+    event.insert("cat", QStringLiteral("evdash"));
+    event.insert("name", name);
+    event.insert("id", traceId);
+    event.insert("pid", QCoreApplication::applicationPid());
+
+    // Tracing may have been disabled by a failed rotation meanwhile
+    QMutexLocker locker(&m_mutex);
+    if (!enabled())
+        return;
+
+    event.insert("tid", threadId());
+
+    QJsonObject beginEvent = event;
+    beginEvent.insert("ph", QStringLiteral("b"));
+    beginEvent.insert("ts", start);
+    if (!args.isEmpty())
+        beginEvent.insert("args", QJsonObject::fromVariantMap(args));
+
+    QJsonObject endEvent = event;
+    endEvent.insert("ph", QStringLiteral("e"));
+    endEvent.insert("ts", qMax(start, end));
+
+    appendEvent(QJsonDocument(beginEvent).toJson(QJsonDocument::Compact));
+    appendEvent(QJsonDocument(endEvent).toJson(QJsonDocument::Compact));
+
+    if (m_buffer.size() >= s_flushThreshold)
+        writeBuffer();
+}
+
+void EvDashTracer::flush()
+{
+    QMutexLocker locker(&m_mutex);
+    writeBuffer();
+    m_file.flush();
+}
+
+bool EvDashTracer::openFile()
+{
+    m_file.setFileName(m_directory + "/evdash-trace.json");
+    if (!m_file.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+
+    // The closing bracket is optional in the trace event format, files stay loadable after a crash
+    m_file.write("[\n");
+    m_firstEvent = true;
+    m_threadIds.clear();
+    return true;
+}
+
+void EvDashTracer::closeFile()
+{
+    if (!m_file.isOpen())
+        return;
+
+    m_file.write("\n]\n");
+    m_file.close();
+}
+
+void EvDashTracer::rotate()
+{
+    closeFile();
+
+    const QString baseName = m_file.fileName();
+    QFile::remove(QStringLiteral("%1.%2").arg(baseName).arg(m_maxFiles - 1));
+    for (int i = m_maxFiles - 2; i >= 1; i--)
+        QFile::rename(QStringLiteral("%1.%2").arg(baseName).arg(i), QStringLiteral("%1.%2").arg(baseName).arg(i + 1));
+
+    if (m_maxFiles > 1) {
+        QFile::rename(baseName, baseName + ".1");
+    }
+
+    if (!openFile()) {
+        qCWarning(dcEvDashExperience()) << "Could not open new trace file" << baseName << ". Tracing disabled.";
+        m_enabled.storeRelease(0);
+    }
+}
+
+void EvDashTracer::writeBuffer()
+{
+    if (m_buffer.isEmpty() || !m_file.isOpen())
+        return;
+
+    m_file.write(m_buffer);
+    m_buffer.clear();
+
+    if (m_file.size() >= m_maxFileSize)
+        rotate();
+}
+
+void EvDashTracer::appendEvent(const QByteArray &event)
+{
+    if (!m_firstEvent)
+        m_buffer.append(",\n");
+
+    m_buffer.append(event);
+    m_firstEvent = false;
+}
+
+int EvDashTracer::threadId()
+{
+    const Qt::HANDLE handle = QThread::currentThreadId();
+    auto it = m_threadIds.constFind(handle);
+    if (it != m_threadIds.constEnd())
+        return it.value();
+
+    const int id = m_threadIds.count() + 1;
+    m_threadIds.insert(handle, id);
+
+    // Name the thread once per file
+    QString threadName = QThread::currentThread()->objectName();
+    if (threadName.isEmpty())
+        threadName = QThread::currentThread() == qApp->thread() ? QStringLiteral("main") : QStringLiteral("thread-%1").arg(id);
+
+    QJsonObject metadata;
+    metadata.insert("name", QStringLiteral("thread_name"));
+    metadata.insert("ph", QStringLiteral("M"));
+    metadata.insert("pid", QCoreApplication::applicationPid());
+    metadata.insert("tid", id);
+    metadata.insert("args", QJsonObject{{"name", threadName}});
+    appendEvent(QJsonDocument(metadata).toJson(QJsonDocument::Compact));
+    return id;
+}
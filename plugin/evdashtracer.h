@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef EVDASHTRACER_H
+#define EVDASHTRACER_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVariantMap>
+
+class QTimer;
+
+// Opt-in request tracing. Spans are grouped by a trace id, for requests the
+// client id and the requestId, and written as nestable async events in the
+// Chrome trace event format, which can be loaded into Perfetto or
+// chrome://tracing. Files are rotated once they reach the configured size.
+// addSpan() may be called from any thread.
+class EvDashTracer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EvDashTracer(QObject *parent = nullptr);
+    ~EvDashTracer() override;
+
+    bool enabled() const;
+
+    // Monotonic timestamp in microseconds, comparable across threads
+    static qint64 now();
+
+    static QString requestTraceId(quint64 clientId, const QString &requestId);
+
+    void addSpan(const QString &traceId, const QString &name, qint64 start, qint64 end, const QVariantMap &args = QVariantMap());
+
+public slots:
+    void flush();
+
+private:
+    static constexpr int s_flushThreshold = 64 * 1024;
+
+    // Read without the mutex by addSpan(), cleared by rotate() if the new file cannot be opened
+    QAtomicInt m_enabled;
+    QString m_directory;
+    qint64 m_maxFileSize = 10 * 1024 * 1024;
+    int m_maxFiles = 5;
+
+    QTimer *m_flushTimer = nullptr;
+
+    mutable QMutex m_mutex;
+    QFile m_file;
+    QByteArray m_buffer;
+    bool m_firstEvent = true;
+    QHash<Qt::HANDLE, int> m_threadIds;
+
+    bool openFile();
+    void closeFile();
+    void rotate();
+    void writeBuffer();
+    void appendEvent(const QByteArray &event);
+    int threadId();
+};
+
+#endif // EVDASHTRACER_H
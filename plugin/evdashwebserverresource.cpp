@@ -24,20 +24,28 @@
 
 #include "evdashwebserverresource.h"
 #include "evdashsettings.h"
+#include "evdashsettingsstore.h"
+#include "evdashstatistics.h"
 
 #include <QCryptographicHash>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonParseError>
 #include <QRegularExpression>
+#include <QTimer>
+#include <QUrlQuery>
 #include <QUuid>
+#include <QtMath>
 
 #include <QLoggingCategory>
 Q_DECLARE_LOGGING_CATEGORY(dcEvDashExperience)
 
-EvDashWebServerResource::EvDashWebServerResource(QObject *parent)
+EvDashWebServerResource::EvDashWebServerResource(EvDashSettingsStore *settingsStore, EvDashStatistics *statistics, QObject *parent)
     : WebServerResource{"/evdash", parent}
+    , m_settingsStore{settingsStore}
+    , m_statistics{statistics}
 {
     // Load users
     EvDashSettings settings;
@@ -58,19 +66,130 @@ EvDashWebServerResource::EvDashWebServerResource(QObject *parent)
     settings.endGroup(); // Users
 
     qCInfo(dcEvDashExperience()) << "Loaded" << m_users.count() << "users for the dashboard.";
+
+    settings.beginGroup("LoginThrottle");
+    m_admissionBurst = qMax(1, settings.value("burst", m_admissionBurst).toInt());
+    m_admissionRefillInterval = qMax(1, settings.value("refillInterval", m_admissionRefillInterval).toInt());
+    m_globalAdmissionBurst = qMax(m_admissionBurst, settings.value("globalBurst", m_globalAdmissionBurst).toInt());
+    m_globalAdmissionReserve = qBound(0, settings.value("globalReserve", m_globalAdmissionReserve).toInt(), m_globalAdmissionBurst - 1);
+    // Only enable if the web server can be reached through the proxy alone, clients could set the headers otherwise
+    m_trustForwardingHeaders = settings.value("trustForwardingHeaders", m_trustForwardingHeaders).toBool();
+    const QStringList trustedProxies = settings.value("trustedProxies").toStringList();
+    for (const QString &trustedProxy : trustedProxies) {
+        // Proxies in front of the last one, single addresses or subnets like 10.0.0.0/8
+        QPair<QHostAddress, int> subnet = QHostAddress::parseSubnet(trustedProxy.trimmed());
+        if (subnet.first.isNull()) {
+            const QHostAddress address(trustedProxy.trimmed());
+            subnet = qMakePair(address, address.protocol() == QAbstractSocket::IPv6Protocol ? 128 : 32);
+        }
+
+        if (subnet.first.isNull()) {
+            qCWarning(dcEvDashExperience()) << "Ignoring invalid trusted proxy address" << trustedProxy;
+            continue;
+        }
+
+        m_trustedProxies.append(subnet);
+    }
+    settings.endGroup(); // LoginThrottle
+
+    settings.beginGroup("Metrics");
+    m_metricsRequireAuthentication = settings.value("requireAuthentication", m_metricsRequireAuthentication).toBool();
+    settings.endGroup(); // Metrics
+
+    // Stay below the web server timeout for asynchronous replies
+    settings.beginGroup("LongPoll");
+    m_changesMaxTimeout = qBound(1, settings.value("maxTimeout", m_changesMaxTimeout).toInt(), 60);
+    m_changesMaxWaiting = qMax(1, settings.value("maxWaiting", m_changesMaxWaiting).toInt());
+    settings.endGroup(); // LongPoll
+
+    // Changes arriving in a burst are answered together
+    m_changesTimer = new QTimer(this);
+    m_changesTimer->setSingleShot(true);
+    m_changesTimer->setInterval(100);
+    connect(m_changesTimer, &QTimer::timeout, this, [this]() { finishChangesRequests(false); });
+
+    m_admissionClock.start();
+    m_globalAdmissionBucket.tokens = m_globalAdmissionBurst;
+}
+
+void EvDashWebServerResource::setEngine(EvDashEngine *engine)
+{
+    if (m_engine)
+        disconnect(m_engine, nullptr, this, nullptr);
+
+    m_engine = engine;
+    if (!m_engine)
+        return;
+
+    connect(m_engine, &EvDashEngine::stateChanged, this, [this]() {
+        if (!m_changesRequests.isEmpty() && !m_changesTimer->isActive())
+            m_changesTimer->start();
+    });
 }
 
 HttpReply *EvDashWebServerResource::processRequest(const HttpRequest &request)
 {
     qCDebug(dcEvDashExperience()) << "Process request" << request.url().toString();
 
+    QElapsedTimer requestTimer;
+    requestTimer.start();
+
+    QString route = QStringLiteral("static");
+    HttpReply *reply = dispatchRequest(request, &route);
+    m_statistics->observeDuration("evdash_http_request_duration_seconds", route, requestTimer.nsecsElapsed());
+    return reply;
+}
+
+HttpReply *EvDashWebServerResource::dispatchRequest(const HttpRequest &request, QString *route)
+{
     const QString path = request.url().path();
 
-    if (path == basePath() + QStringLiteral("/api/login"))
+    // Reject throttled login and refresh attempts before parsing or hashing anything
+    const bool isLoginRequest = path == basePath() + QStringLiteral("/api/login");
+    const bool isRefreshRequest = path == basePath() + QStringLiteral("/api/refresh");
+    if (isLoginRequest || isRefreshRequest) {
+        int retryAfterSeconds = 0;
+        if (!admitAttempt(request, &retryAfterSeconds)) {
+            if (isLoginRequest) {
+                m_rejectedLoginAttempts++;
+            } else {
+                m_rejectedRefreshAttempts++;
+            }
+
+            *route = isLoginRequest ? QStringLiteral("login") : QStringLiteral("refresh");
+            m_statistics->incrementCounter("evdash_http_rejected_attempts_total", *route);
+            return createTooManyRequestsReply(retryAfterSeconds);
+        }
+    }
+
+    if (isLoginRequest) {
+        *route = QStringLiteral("login");
         return handleLoginRequest(request);
+    }
 
-    if (path == basePath() + QStringLiteral("/api/refresh"))
+    if (isRefreshRequest) {
+        *route = QStringLiteral("refresh");
         return handleRefreshRequest(request);
+    }
+
+    if (path == basePath() + QStringLiteral("/api/metrics")) {
+        *route = QStringLiteral("metrics");
+        return handleMetricsRequest(request);
+    }
+
+    if (path == basePath() + QStringLiteral("/api/changes")) {
+        *route = QStringLiteral("changes");
+        return handleChangesRequest(request);
+    }
+
+    // Read only state for integrations
+    const QString stateBasePath = basePath() + QStringLiteral("/api/");
+    const QString stateResource = path.mid(stateBasePath.length());
+    if (path.startsWith(stateBasePath)
+        && (stateResource == QStringLiteral("chargers") || stateResource == QStringLiteral("cars") || stateResource.startsWith(QStringLiteral("chargers/")))) {
+        *route = QStringLiteral("state");
+        return handleStateRequest(request, stateResource);
+    }
 
     // Verify methods for static content
     if (request.method() != HttpRequest::Get) {
@@ -102,9 +221,100 @@ QStringList EvDashWebServerResource::usernames() const
     return m_users.keys();
 }
 
+quint64 EvDashWebServerResource::rejectedLoginAttempts() const
+{
+    return m_rejectedLoginAttempts;
+}
+
+quint64 EvDashWebServerResource::rejectedRefreshAttempts() const
+{
+    return m_rejectedRefreshAttempts;
+}
+
 EvDashEngine::EvDashError EvDashWebServerResource::addUser(const QString &username, const QString &password)
 {
-    if (m_users.keys().contains(username)) {
+    const EvDashEngine::EvDashError error = validateNewUser(username, password);
+    if (error != EvDashEngine::EvDashErrorNoError)
+        return error;
+
+    storeUser(username, password);
+    emit userAdded(username);
+
+    return EvDashEngine::EvDashErrorNoError;
+}
+
+EvDashEngine::EvDashError EvDashWebServerResource::removeUser(const QString &username)
+{
+    if (!m_users.contains(username)) {
+        qCWarning(dcEvDashExperience()) << "Cannot remove user with username" << username << "because there is no such user.";
+        return EvDashEngine::EvDashErrorUserNotFound;
+    }
+
+    deleteUser(username);
+    emit userRemoved(username);
+
+    return EvDashEngine::EvDashErrorNoError;
+}
+
+EvDashEngine::EvDashError EvDashWebServerResource::addUsers(const QList<QPair<QString, QString>> &users, QString *failedUsername)
+{
+    QStringList usernames;
+    for (const auto &user : users) {
+        EvDashEngine::EvDashError error = validateNewUser(user.first, user.second);
+        if (error == EvDashEngine::EvDashErrorNoError && usernames.contains(user.first)) {
+            qCWarning(dcEvDashExperience()) << "Cannot add new users. The username" << user.first << "has been given more than once";
+            error = EvDashEngine::EvDashErrorDuplicateUser;
+        }
+
+        if (error != EvDashEngine::EvDashErrorNoError) {
+            if (failedUsername)
+                *failedUsername = user.first;
+
+            return error;
+        }
+
+        usernames.append(user.first);
+    }
+
+    for (const auto &user : users)
+        storeUser(user.first, user.second);
+
+    m_settingsStore->commit();
+
+    for (const QString &username : qAsConst(usernames))
+        emit userAdded(username);
+
+    return EvDashEngine::EvDashErrorNoError;
+}
+
+EvDashEngine::EvDashError EvDashWebServerResource::removeUsers(const QStringList &usernames, QString *failedUsername)
+{
+    for (const QString &username : usernames) {
+        if (!m_users.contains(username)) {
+            qCWarning(dcEvDashExperience()) << "Cannot remove users because there is no user with username" << username;
+            if (failedUsername)
+                *failedUsername = username;
+
+            return EvDashEngine::EvDashErrorUserNotFound;
+        }
+    }
+
+    QStringList removedUsernames = usernames;
+    removedUsernames.removeDuplicates();
+    for (const QString &username : qAsConst(removedUsernames))
+        deleteUser(username);
+
+    m_settingsStore->commit();
+
+    for (const QString &username : qAsConst(removedUsernames))
+        emit userRemoved(username);
+
+    return EvDashEngine::EvDashErrorNoError;
+}
+
+EvDashEngine::EvDashError EvDashWebServerResource::validateNewUser(const QString &username, const QString &password) const
+{
+    if (m_users.contains(username)) {
         qCWarning(dcEvDashExperience()) << "Cannot add new user. There is already a user with the username" << username;
         return EvDashEngine::EvDashErrorDuplicateUser;
     }
@@ -114,34 +324,26 @@ EvDashEngine::EvDashError EvDashWebServerResource::addUser(const QString &userna
         return EvDashEngine::EvDashErrorBadPassword;
     }
 
+    return EvDashEngine::EvDashErrorNoError;
+}
+
+void EvDashWebServerResource::storeUser(const QString &username, const QString &password)
+{
     UserInfo info;
     info.username = username;
     info.passwordSalt = QUuid::createUuid().toString().remove(QRegularExpression("[{}]")).toUtf8();
     info.passwordHash = QCryptographicHash::hash(QString(password + info.passwordSalt).toUtf8(), QCryptographicHash::Sha3_512).toBase64();
 
-    EvDashSettings settings;
-    settings.beginGroup("Users");
-    settings.beginGroup(username);
-    settings.setValue("hash", QString::fromUtf8(info.passwordHash));
-    settings.setValue("salt", QString::fromUtf8(info.passwordSalt));
-    settings.endGroup(); // username
-    settings.endGroup(); // Users
+    m_settingsStore->setValue(QStringLiteral("Users/%1/hash").arg(username), QString::fromUtf8(info.passwordHash));
+    m_settingsStore->setValue(QStringLiteral("Users/%1/salt").arg(username), QString::fromUtf8(info.passwordSalt));
 
     qCDebug(dcEvDashExperience()) << "Added successfully new user with username" << username;
 
     m_users.insert(username, info);
-    emit userAdded(username);
-
-    return EvDashEngine::EvDashErrorNoError;
 }
 
-EvDashEngine::EvDashError EvDashWebServerResource::removeUser(const QString &username)
+void EvDashWebServerResource::deleteUser(const QString &username)
 {
-    if (!m_users.contains(username)) {
-        qCWarning(dcEvDashExperience()) << "Cannot remove user with username" << username << "because there is no such user.";
-        return EvDashEngine::EvDashErrorUserNotFound;
-    }
-
     m_users.remove(username);
 
     foreach (const QString &token, m_activeTokens.keys()) {
@@ -151,16 +353,9 @@ EvDashEngine::EvDashError EvDashWebServerResource::removeUser(const QString &use
         }
     }
 
-    EvDashSettings settings;
-    settings.beginGroup("Users");
-    settings.remove(username);
-    settings.endGroup(); // Users
+    m_settingsStore->remove(QStringLiteral("Users/%1").arg(username));
 
     qCDebug(dcEvDashExperience()) << "User with username" << username << "removed successfully";
-
-    emit userRemoved(username);
-
-    return EvDashEngine::EvDashErrorNoError;
 }
 
 HttpReply *EvDashWebServerResource::redirectToIndex()
@@ -245,6 +440,159 @@ HttpReply *EvDashWebServerResource::handleRefreshRequest(const HttpRequest &requ
     return HttpReply::createJsonReply(QJsonDocument(payload));
 }
 
+HttpReply *EvDashWebServerResource::handleMetricsRequest(const HttpRequest &request)
+{
+    if (request.method() != HttpRequest::Get) {
+        HttpReply *reply = HttpReply::createErrorReply(HttpReply::MethodNotAllowed);
+        reply->setHeader(HttpReply::AllowHeader, "GET");
+        return reply;
+    }
+
+    if (m_metricsRequireAuthentication && !authorizeRequest(request))
+        return createUnauthorizedReply();
+
+    HttpReply *reply = new HttpReply(HttpReply::Ok, HttpReply::TypeSync);
+    reply->setHeader(HttpReply::ContentTypeHeader, "text/plain; version=0.0.4; charset=utf-8");
+    reply->setPayload(m_statistics->toPrometheusText());
+    return reply;
+}
+
+HttpReply *EvDashWebServerResource::handleStateRequest(const HttpRequest &request, const QString &resource)
+{
+    if (request.method() != HttpRequest::Get) {
+        HttpReply *reply = HttpReply::createErrorReply(HttpReply::MethodNotAllowed);
+        reply->setHeader(HttpReply::AllowHeader, "GET");
+        return reply;
+    }
+
+    if (!authorizeRequest(request))
+        return createUnauthorizedReply();
+
+    if (!m_engine)
+        return HttpReply::createErrorReply(HttpReply::ServiceUnavailable);
+
+    // Unchanged state is confirmed without encoding anything
+    const QByteArray eTag = m_engine->stateETag();
+    const QList<QByteArray> ifNoneMatch = headerValue(request, "if-none-match").split(',');
+    for (const QByteArray &tag : ifNoneMatch) {
+        const QByteArray trimmedTag = tag.trimmed();
+        if (trimmedTag == eTag || trimmedTag == "W/" + eTag || trimmedTag == "*") {
+            HttpReply *reply = HttpReply::createErrorReply(HttpReply::NotModified);
+            reply->setRawHeader("ETag", eTag);
+            return reply;
+        }
+    }
+
+    bool found = false;
+    const QByteArray payload = m_engine->encodedState(resource, &found);
+    if (!found) {
+        QJsonObject response{{QStringLiteral("success"), false}, {QStringLiteral("error"), QStringLiteral("notFound")}};
+        return HttpReply::createJsonReply(QJsonDocument(response), HttpReply::NotFound);
+    }
+
+    HttpReply *reply = new HttpReply(HttpReply::Ok, HttpReply::TypeSync);
+    reply->setHeader(HttpReply::ContentTypeHeader, "application/json; charset=\"utf-8\";");
+    reply->setHeader(HttpReply::CacheControlHeader, "no-cache");
+    reply->setRawHeader("ETag", eTag);
+    reply->setPayload(payload);
+    return reply;
+}
+
+HttpReply *EvDashWebServerResource::handleChangesRequest(const HttpRequest &request)
+{
+    if (request.method() != HttpRequest::Get) {
+        HttpReply *reply = HttpReply::createErrorReply(HttpReply::MethodNotAllowed);
+        reply->setHeader(HttpReply::AllowHeader, "GET");
+        return reply;
+    }
+
+    if (!authorizeRequest(request))
+        return createUnauthorizedReply();
+
+    if (!m_engine)
+        return HttpReply::createErrorReply(HttpReply::ServiceUnavailable);
+
+    const QUrlQuery query = request.urlQuery();
+    bool valid = true;
+    const quint64 since = query.hasQueryItem(QStringLiteral("since")) ? query.queryItemValue(QStringLiteral("since")).toULongLong(&valid) : 0;
+    if (!valid) {
+        QJsonObject response{{QStringLiteral("success"), false}, {QStringLiteral("error"), QStringLiteral("invalidSince")}};
+        return HttpReply::createJsonReply(QJsonDocument(response), HttpReply::BadRequest);
+    }
+
+    const int timeout = query.hasQueryItem(QStringLiteral("timeout")) ? query.queryItemValue(QStringLiteral("timeout")).toInt(&valid) : m_changesMaxTimeout;
+    if (!valid || timeout < 0) {
+        QJsonObject response{{QStringLiteral("success"), false}, {QStringLiteral("error"), QStringLiteral("invalidTimeout")}};
+        return HttpReply::createJsonReply(QJsonDocument(response), HttpReply::BadRequest);
+    }
+
+    // Answer right away if something changed already, or if the client does not want to wait
+    const QString epoch = query.queryItemValue(QStringLiteral("epoch"));
+    if (since == 0 || since != m_engine->stateVersion() || (!epoch.isEmpty() && epoch != m_engine->epoch()) || timeout == 0) {
+        HttpReply *reply = new HttpReply(HttpReply::Ok, HttpReply::TypeSync);
+        writeChanges(reply, since, epoch.isEmpty() ? m_engine->epoch() : epoch);
+        return reply;
+    }
+
+    if (m_changesRequests.count() >= m_changesMaxWaiting) {
+        HttpReply *reply = HttpReply::createErrorReply(HttpReply::ServiceUnavailable);
+        reply->setRawHeader("Retry-After", "1");
+        return reply;
+    }
+
+    ChangesRequest changesRequest;
+    changesRequest.reply = new HttpReply(HttpReply::Ok, HttpReply::TypeAsync);
+    changesRequest.since = since;
+    changesRequest.epoch = m_engine->epoch();
+    changesRequest.timeoutTimer = new QTimer(this);
+    changesRequest.timeoutTimer->setSingleShot(true);
+    changesRequest.timeoutTimer->start(qMin(timeout, m_changesMaxTimeout) * 1000);
+    connect(changesRequest.timeoutTimer, &QTimer::timeout, this, [this]() { finishChangesRequests(true); });
+    m_changesRequests.append(changesRequest);
+    return changesRequest.reply;
+}
+
+void EvDashWebServerResource::finishChangesRequests(bool timedOutOnly)
+{
+    for (int i = m_changesRequests.count() - 1; i >= 0; i--) {
+        const ChangesRequest changesRequest = m_changesRequests.at(i);
+        if (timedOutOnly && changesRequest.timeoutTimer->isActive())
+            continue;
+
+        m_changesRequests.removeAt(i);
+        changesRequest.timeoutTimer->deleteLater();
+
+        // The web server deletes replies of closed connections
+        if (!changesRequest.reply)
+            continue;
+
+        writeChanges(changesRequest.reply, changesRequest.since, changesRequest.epoch);
+        emit changesRequest.reply->finished();
+    }
+}
+
+void EvDashWebServerResource::writeChanges(HttpReply *reply, quint64 since, const QString &epoch)
+{
+    const QJsonObject changes = m_engine->changesSince(since, epoch);
+    reply->setHttpStatusCode(HttpReply::Ok);
+    reply->setHeader(HttpReply::ContentTypeHeader, "application/json; charset=\"utf-8\";");
+    reply->setHeader(HttpReply::CacheControlHeader, "no-store");
+    reply->setPayload(QJsonDocument(changes).toJson(QJsonDocument::Compact));
+}
+
+HttpReply *EvDashWebServerResource::createUnauthorizedReply() const
+{
+    HttpReply *reply = HttpReply::createErrorReply(HttpReply::Unauthorized);
+    reply->setRawHeader("WWW-Authenticate", "Bearer");
+    return reply;
+}
+
+bool EvDashWebServerResource::authorizeRequest(const HttpRequest &request)
+{
+    const QByteArray authorization = headerValue(request, "authorization");
+    return authorization.startsWith("Bearer ") && validateToken(QString::fromUtf8(authorization.mid(7).trimmed()));
+}
+
 bool EvDashWebServerResource::verifyCredentials(const QString &username, const QString &password) const
 {
     const UserInfo info = m_users.value(username);
@@ -294,3 +642,142 @@ void EvDashWebServerResource::purgeExpiredTokens()
             ++it;
     }
 }
+
+bool EvDashWebServerResource::admitAttempt(const HttpRequest &request, int *retryAfterSeconds)
+{
+    const qint64 now = m_admissionClock.elapsed();
+
+    // Without a trustworthy source only the global rate applies
+    const QString source = admissionSource(request);
+    if (source.isEmpty()) {
+        if (!takeAdmissionToken(m_globalAdmissionBucket, m_globalAdmissionBurst, now, retryAfterSeconds)) {
+            qCDebug(dcEvDashExperience()) << "Throttling login attempt because the global login rate has been exceeded";
+            return false;
+        }
+
+        return true;
+    }
+
+    auto it = m_admissionBuckets.find(source);
+    if (it == m_admissionBuckets.end()) {
+        if (m_admissionBuckets.count() >= s_maxAdmissionBuckets)
+            purgeAdmissionBuckets(now);
+
+        AdmissionBucket bucket;
+        bucket.tokens = m_admissionBurst;
+        bucket.lastRefill = now;
+        it = m_admissionBuckets.insert(source, bucket);
+    }
+
+    // Sources retrying may not use the reserved part of the global bucket
+    const bool firstAttempt = it->tokens + static_cast<double>(now - it->lastRefill) / m_admissionRefillInterval >= m_admissionBurst;
+
+    if (!takeAdmissionToken(it.value(), m_admissionBurst, now, retryAfterSeconds)) {
+        qCDebug(dcEvDashExperience()) << "Throttling login attempt from" << source << "Retry after" << *retryAfterSeconds << "s";
+        return false;
+    }
+
+    if (!takeAdmissionToken(m_globalAdmissionBucket, m_globalAdmissionBurst, now, retryAfterSeconds, firstAttempt ? 0 : m_globalAdmissionReserve)) {
+        // Give the per source token back, the attempt has not been processed
+        it->tokens = qMin<double>(m_admissionBurst, it->tokens + 1);
+        qCDebug(dcEvDashExperience()) << "Throttling login attempt from" << source << "because the global login rate has been exceeded";
+        return false;
+    }
+
+    return true;
+}
+
+bool EvDashWebServerResource::takeAdmissionToken(AdmissionBucket &bucket, int burst, qint64 now, int *retryAfterSeconds, int reserve) const
+{
+    const double refilled = static_cast<double>(now - bucket.lastRefill) / m_admissionRefillInterval;
+    bucket.tokens = qMin<double>(burst, bucket.tokens + refilled);
+    bucket.lastRefill = now;
+
+    if (bucket.tokens >= 1 + reserve) {
+        bucket.tokens -= 1;
+        return true;
+    }
+
+    *retryAfterSeconds = qMax(1, qCeil((1 + reserve - bucket.tokens) * m_admissionRefillInterval / 1000.0));
+    return false;
+}
+
+void EvDashWebServerResource::purgeAdmissionBuckets(qint64 now)
+{
+    // Buckets which would be full again by now carry no information
+    auto it = m_admissionBuckets.begin();
+    while (it != m_admissionBuckets.end()) {
+        const double refilled = static_cast<double>(now - it->lastRefill) / m_admissionRefillInterval;
+        if (it->tokens + refilled >= m_admissionBurst) {
+            it = m_admissionBuckets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (m_admissionBuckets.count() < s_maxAdmissionBuckets)
+        return;
+
+    // Still too many distinct sources, drop the one which has been quiet the longest.
+    // The global bucket keeps limiting sources which come back with a fresh bucket.
+    auto oldest = m_admissionBuckets.begin();
+    for (auto bucket = m_admissionBuckets.begin(); bucket != m_admissionBuckets.end(); ++bucket) {
+        if (bucket->lastRefill < oldest->lastRefill)
+            oldest = bucket;
+    }
+
+    m_admissionBuckets.erase(oldest);
+}
+
+QString EvDashWebServerResource::admissionSource(const HttpRequest &request) const
+{
+    if (!m_trustForwardingHeaders)
+        return QString();
+
+    // The client is the last forwarded address which has not been added by one of our proxies
+    const QList<QByteArray> addresses = headerValue(request, "x-forwarded-for").split(',');
+    for (int i = addresses.count() - 1; i >= 0; i--) {
+        const QHostAddress address(QString::fromLatin1(addresses.at(i).trimmed()));
+        if (address.isNull())
+            break;
+
+        if (!isTrustedProxy(address))
+            return address.toString();
+    }
+
+    const QHostAddress address(QString::fromLatin1(headerValue(request, "x-real-ip").trimmed()));
+    if (!address.isNull())
+        return address.toString();
+
+    return QString();
+}
+
+QByteArray EvDashWebServerResource::headerValue(const HttpRequest &request, const QByteArray &name)
+{
+    // Header names are case insensitive, the name is expected in lower case
+    const QHash<QByteArray, QByteArray> headers = request.rawHeaderList();
+    for (auto it = headers.constBegin(); it != headers.constEnd(); ++it) {
+        if (it.key().trimmed().toLower() == name)
+            return it.value();
+    }
+
+    return QByteArray();
+}
+
+bool EvDashWebServerResource::isTrustedProxy(const QHostAddress &address) const
+{
+    for (const QPair<QHostAddress, int> &subnet : m_trustedProxies) {
+        if (address.isInSubnet(subnet))
+            return true;
+    }
+
+    return false;
+}
+
+HttpReply *EvDashWebServerResource::createTooManyRequestsReply(int retryAfterSeconds) const
+{
+    QJsonObject payload{{QStringLiteral("success"), false}, {QStringLiteral("error"), QStringLiteral("tooManyRequests")}};
+    HttpReply *reply = HttpReply::createJsonReply(QJsonDocument(payload), static_cast<HttpReply::HttpStatusCode>(s_httpTooManyRequests));
+    reply->setRawHeader("Retry-After", QByteArray::number(retryAfterSeconds));
+    return reply;
+}
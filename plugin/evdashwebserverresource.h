@@ -26,8 +26,13 @@
 #define EVDASHWEBSERVERRESOURCE_H
 
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QHostAddress>
+#include <QList>
 #include <QObject>
+#include <QPair>
+#include <QPointer>
 #include <QString>
 
 #include <webserver/webserverresource.h>
@@ -35,28 +40,45 @@
 #include "evdashengine.h"
 
 class QJsonObject;
+class EvDashSettingsStore;
+class EvDashStatistics;
+class QTimer;
 
 class EvDashWebServerResource : public WebServerResource
 {
     Q_OBJECT
 public:
-    explicit EvDashWebServerResource(QObject *parent = nullptr);
+    explicit EvDashWebServerResource(EvDashSettingsStore *settingsStore, EvDashStatistics *statistics, QObject *parent = nullptr);
 
     HttpReply *processRequest(const HttpRequest &request) override;
 
+    // Source of the REST API state
+    void setEngine(EvDashEngine *engine);
+
     // User management
     QStringList usernames() const;
 
     EvDashEngine::EvDashError addUser(const QString &username, const QString &password);
     EvDashEngine::EvDashError removeUser(const QString &username);
 
+    // Bulk variants, either all users are added or removed or none. The
+    // settings are committed once for the whole list.
+    EvDashEngine::EvDashError addUsers(const QList<QPair<QString, QString>> &users, QString *failedUsername = nullptr);
+    EvDashEngine::EvDashError removeUsers(const QStringList &usernames, QString *failedUsername = nullptr);
+
     bool validateToken(const QString &token);
 
+    // Login admission control
+    quint64 rejectedLoginAttempts() const;
+    quint64 rejectedRefreshAttempts() const;
+
 signals:
     void userAdded(const QString &username);
     void userRemoved(const QString &username);
 
 private:
+    friend class EvDashEngineBenchmark;
+
     struct TokenInfo
     {
         QString username;
@@ -70,15 +92,80 @@ private:
         QByteArray passwordSalt;
     };
 
+    struct AdmissionBucket
+    {
+        double tokens = 0;
+        qint64 lastRefill = 0;
+    };
+
     static constexpr int s_tokenLifetimeSeconds = 3600;
     static constexpr int s_minimalPasswordLength = 4;
+    static constexpr int s_maxAdmissionBuckets = 1024;
+    static constexpr int s_httpTooManyRequests = 429;
+
+    EvDashSettingsStore *m_settingsStore = nullptr;
+    EvDashStatistics *m_statistics = nullptr;
+    EvDashEngine *m_engine = nullptr;
+    bool m_metricsRequireAuthentication = true;
+
+    // Long polling change feed requests waiting for the next state change
+    struct ChangesRequest
+    {
+        QPointer<HttpReply> reply;
+        quint64 since = 0;
+        QString epoch;
+        QTimer *timeoutTimer = nullptr;
+    };
+
+    QList<ChangesRequest> m_changesRequests;
+    QTimer *m_changesTimer = nullptr;
+    int m_changesMaxTimeout = 8;
+    int m_changesMaxWaiting = 64;
 
     QHash<QString, UserInfo> m_users;
     QHash<QString, TokenInfo> m_activeTokens;
 
+    // Token buckets throttling login and refresh attempts. The HTTP request does not
+    // expose the peer socket, so sources are only told apart by the forwarding headers
+    // if the operator declared them trustworthy. Every attempt is charged to the global
+    // bucket. Its last tokens are reserved for sources without recent attempts, so one
+    // retrying source cannot lock out everybody else.
+    QElapsedTimer m_admissionClock;
+    bool m_trustForwardingHeaders = false;
+    QList<QPair<QHostAddress, int>> m_trustedProxies;
+    QHash<QString, AdmissionBucket> m_admissionBuckets;
+    AdmissionBucket m_globalAdmissionBucket;
+    int m_admissionBurst = 5;
+    int m_admissionRefillInterval = 2000;
+    int m_globalAdmissionBurst = 20;
+    int m_globalAdmissionReserve = 5;
+    quint64 m_rejectedLoginAttempts = 0;
+    quint64 m_rejectedRefreshAttempts = 0;
+
+    EvDashEngine::EvDashError validateNewUser(const QString &username, const QString &password) const;
+    void storeUser(const QString &username, const QString &password);
+    void deleteUser(const QString &username);
+
+    bool admitAttempt(const HttpRequest &request, int *retryAfterSeconds);
+    bool takeAdmissionToken(AdmissionBucket &bucket, int burst, qint64 now, int *retryAfterSeconds, int reserve = 0) const;
+    void purgeAdmissionBuckets(qint64 now);
+    QString admissionSource(const HttpRequest &request) const;
+    static QByteArray headerValue(const HttpRequest &request, const QByteArray &name);
+    bool isTrustedProxy(const QHostAddress &address) const;
+    HttpReply *createTooManyRequestsReply(int retryAfterSeconds) const;
+
+    HttpReply *dispatchRequest(const HttpRequest &request, QString *route);
     HttpReply *handleLoginRequest(const HttpRequest &request);
+    HttpReply *handleMetricsRequest(const HttpRequest &request);
     HttpReply *handleRefreshRequest(const HttpRequest &request);
+    HttpReply *handleStateRequest(const HttpRequest &request, const QString &resource);
+    HttpReply *handleChangesRequest(const HttpRequest &request);
+    void finishChangesRequests(bool timedOutOnly);
+    void writeChanges(HttpReply *reply, quint64 since, const QString &epoch);
     HttpReply *redirectToIndex();
+    HttpReply *createUnauthorizedReply() const;
+
+    bool authorizeRequest(const HttpRequest &request);
 
     QString issueToken(const QString &username);
     void purgeExpiredTokens();
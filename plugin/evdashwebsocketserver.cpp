@@ -0,0 +1,315 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "evdashwebsocketserver.h"
+#include "evdashtcpserver.h"
+#include "evdashtlssessioncache.h"
+#include "evdashtracer.h"
+#include "evdashwebsocketworker.h"
+
+#include <QThread>
+#include <QVector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <QLoggingCategory>
+Q_DECLARE_LOGGING_CATEGORY(dcEvDashExperience)
+
+EvDashWebSocketServer::EvDashWebSocketServer(QObject *parent)
+    : QObject{parent}
+{
+    qRegisterMetaType<qintptr>("qintptr");
+    qRegisterMetaType<quint64>("quint64");
+
+    m_tcpServer = new EvDashTcpServer(this);
+    connect(m_tcpServer, &EvDashTcpServer::connectionAvailable, this, &EvDashWebSocketServer::onConnectionAvailable);
+    connect(m_tcpServer, &QTcpServer::acceptError, this, [this](QAbstractSocket::SocketError error) {
+        qCWarning(dcEvDashExperience()) << "WebSocket accept error" << error << m_tcpServer->errorString();
+    });
+}
+
+EvDashWebSocketServer::~EvDashWebSocketServer()
+{
+    close();
+}
+
+void EvDashWebSocketServer::setWorkerCount(int workerCount)
+{
+    m_workerCount = qMax(1, workerCount);
+}
+
+bool EvDashWebSocketServer::setSslConfiguration(const QSslConfiguration &sslConfiguration, bool sessionCache)
+{
+    m_sslConfiguration = sslConfiguration;
+
+    if (!sessionCache) {
+        delete m_tlsSessionCache;
+        m_tlsSessionCache = nullptr;
+    } else if (!m_sslConfiguration.isNull() && !m_tlsSessionCache) {
+        if (EvDashTlsSessionCache::isSupported()) {
+            m_tlsSessionCache = new EvDashTlsSessionCache(this);
+        } else {
+            qCWarning(dcEvDashExperience()) << "TLS session resumption is not supported with the TLS backend in use.";
+        }
+    }
+
+    return !m_sslConfiguration.isNull();
+}
+
+void EvDashWebSocketServer::setHeartbeat(int pingInterval, int pongTimeout)
+{
+    m_pingInterval = pingInterval;
+    m_pongTimeout = pongTimeout;
+}
+
+void EvDashWebSocketServer::setConnectionLimits(int maxClients, int maxClientsPerAddress)
+{
+    m_maxClients = maxClients;
+    m_maxClientsPerAddress = maxClientsPerAddress;
+}
+
+void EvDashWebSocketServer::setTracer(EvDashTracer *tracer)
+{
+    // Workers only get a tracer if tracing is actually enabled
+    m_tracer = tracer && tracer->enabled() ? tracer : nullptr;
+}
+
+bool EvDashWebSocketServer::listen(const QHostAddress &address, quint16 port)
+{
+    if (m_workers.isEmpty())
+        startWorkers();
+
+    return m_tcpServer->listen(address, port);
+}
+
+void EvDashWebSocketServer::close()
+{
+    if (m_tcpServer->isListening())
+        m_tcpServer->close();
+
+    stopWorkers();
+}
+
+bool EvDashWebSocketServer::isListening() const
+{
+    return m_tcpServer->isListening();
+}
+
+bool EvDashWebSocketServer::sslEnabled() const
+{
+    return !m_sslConfiguration.isNull();
+}
+
+QHostAddress EvDashWebSocketServer::serverAddress() const
+{
+    return m_tcpServer->serverAddress();
+}
+
+quint16 EvDashWebSocketServer::serverPort() const
+{
+    return m_tcpServer->serverPort();
+}
+
+QString EvDashWebSocketServer::errorString() const
+{
+    return m_tcpServer->errorString();
+}
+
+int EvDashWebSocketServer::workerCount() const
+{
+    return m_workers.count();
+}
+
+int EvDashWebSocketServer::queueDepth() const
+{
+    int depth = 0;
+    for (EvDashWebSocketWorker *worker : m_workers)
+        depth += worker->queueDepth();
+
+    return depth;
+}
+
+EvDashTlsSessionCache *EvDashWebSocketServer::tlsSessionCache() const
+{
+    return m_tlsSessionCache;
+}
+
+QHostAddress EvDashWebSocketServer::peerAddress(quint64 clientId) const
+{
+    return m_clients.value(clientId).peerAddress;
+}
+
+void EvDashWebSocketServer::sendTextMessage(quint64 clientId, const QByteArray &message, const QString &traceId)
+{
+    auto it = m_clients.constFind(clientId);
+    if (it == m_clients.constEnd())
+        return;
+
+    EvDashFrame frame;
+    frame.clientIds.append(clientId);
+    frame.payload = message;
+    if (m_tracer)
+        frame.traceId = traceId;
+    m_workers.at(it->worker)->enqueueFrame(frame);
+}
+
+void EvDashWebSocketServer::sendTextMessage(const QList<quint64> &clientIds, const QByteArray &message, const QString &traceId)
+{
+    // One frame per worker, the payload is shared between all of them
+    QVector<QVector<quint64>> clientIdsPerWorker(m_workers.count());
+    for (quint64 clientId : clientIds) {
+        auto it = m_clients.constFind(clientId);
+        if (it != m_clients.constEnd())
+            clientIdsPerWorker[it->worker].append(clientId);
+    }
+
+    for (int i = 0; i < clientIdsPerWorker.count(); i++) {
+        if (clientIdsPerWorker.at(i).isEmpty())
+            continue;
+
+        EvDashFrame frame;
+        frame.clientIds = clientIdsPerWorker.at(i);
+        frame.payload = message;
+        if (m_tracer)
+            frame.traceId = traceId;
+        m_workers.at(i)->enqueueFrame(frame);
+    }
+}
+
+void EvDashWebSocketServer::closeClient(quint64 clientId, QWebSocketProtocol::CloseCode closeCode, const QString &reason)
+{
+    auto it = m_clients.constFind(clientId);
+    if (it == m_clients.constEnd())
+        return;
+
+    QMetaObject::invokeMethod(m_workers.at(it->worker),
+                              "closeConnection",
+                              Qt::QueuedConnection,
+                              Q_ARG(quint64, clientId),
+                              Q_ARG(int, static_cast<int>(closeCode)),
+                              Q_ARG(QString, reason));
+}
+
+void EvDashWebSocketServer::startWorkers()
+{
+    for (int i = 0; i < m_workerCount; i++) {
+        EvDashWebSocketWorker *worker = new EvDashWebSocketWorker(i);
+        worker->setSslConfiguration(m_sslConfiguration, m_tlsSessionCache);
+        worker->setHeartbeat(m_pingInterval, m_pongTimeout);
+        worker->setTracer(m_tracer);
+
+        connect(worker, &EvDashWebSocketWorker::clientConnected, this, &EvDashWebSocketServer::onClientConnected);
+        connect(worker, &EvDashWebSocketWorker::clientDisconnected, this, &EvDashWebSocketServer::onClientDisconnected);
+        connect(worker, &EvDashWebSocketWorker::requestReceived, this, &EvDashWebSocketServer::requestReceived);
+        connect(worker, &EvDashWebSocketWorker::invalidRequestReceived, this, &EvDashWebSocketServer::invalidRequestReceived);
+
+        QThread *thread = new QThread(this);
+        thread->setObjectName(QStringLiteral("EvDashSocket%1").arg(i));
+        worker->moveToThread(thread);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+        thread->start();
+
+        m_threads.append(thread);
+        m_workers.append(worker);
+    }
+
+    m_nextWorker = 0;
+    qCDebug(dcEvDashExperience()) << "Started" << m_workers.count() << "WebSocket worker threads";
+}
+
+void EvDashWebSocketServer::stopWorkers()
+{
+    for (int i = 0; i < m_workers.count(); i++) {
+        QMetaObject::invokeMethod(m_workers.at(i), "closeAll", Qt::BlockingQueuedConnection);
+        m_threads.at(i)->quit();
+        m_threads.at(i)->wait();
+        delete m_threads.at(i);
+    }
+
+    m_workers.clear();
+    m_threads.clear();
+    m_clients.clear();
+    m_clientsPerAddress.clear();
+}
+
+void EvDashWebSocketServer::onConnectionAvailable(qintptr socketDescriptor)
+{
+    // Check the limits before spending any time on TLS or the WebSocket handshake
+    sockaddr_storage storage;
+    socklen_t length = sizeof(storage);
+    QHostAddress peerAddress;
+    if (::getpeername(static_cast<int>(socketDescriptor), reinterpret_cast<sockaddr *>(&storage), &length) == 0)
+        peerAddress = QHostAddress(reinterpret_cast<sockaddr *>(&storage));
+
+    if (m_clients.count() >= m_maxClients) {
+        qCWarning(dcEvDashExperience()) << "Rejecting WebSocket client" << peerAddress.toString() << "because the maximum of" << m_maxClients << "clients has been reached";
+        ::close(static_cast<int>(socketDescriptor));
+        return;
+    }
+
+    if (m_clientsPerAddress.value(peerAddress) >= m_maxClientsPerAddress) {
+        qCWarning(dcEvDashExperience()) << "Rejecting WebSocket client" << peerAddress.toString() << "because the maximum of" << m_maxClientsPerAddress
+                                        << "clients per address has been reached";
+        ::close(static_cast<int>(socketDescriptor));
+        return;
+    }
+
+    ClientInfo info;
+    info.worker = m_nextWorker;
+    info.peerAddress = peerAddress;
+    m_nextWorker = (m_nextWorker + 1) % m_workers.count();
+
+    const quint64 clientId = m_nextClientId++;
+    m_clients.insert(clientId, info);
+    m_clientsPerAddress[peerAddress]++;
+
+    QMetaObject::invokeMethod(m_workers.at(info.worker), "addConnection", Qt::QueuedConnection, Q_ARG(quint64, clientId), Q_ARG(qintptr, socketDescriptor));
+}
+
+void EvDashWebSocketServer::onClientConnected(quint64 clientId)
+{
+    auto it = m_clients.find(clientId);
+    if (it == m_clients.end())
+        return;
+
+    it->connected = true;
+    emit clientConnected(clientId);
+}
+
+void EvDashWebSocketServer::onClientDisconnected(quint64 clientId)
+{
+    if (!m_clients.contains(clientId))
+        return;
+
+    const ClientInfo info = m_clients.take(clientId);
+
+    auto it = m_clientsPerAddress.find(info.peerAddress);
+    if (it != m_clientsPerAddress.end() && --it.value() <= 0)
+        m_clientsPerAddress.erase(it);
+
+    if (info.connected)
+        emit clientDisconnected(clientId);
+}
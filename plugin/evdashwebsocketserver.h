@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef EVDASHWEBSOCKETSERVER_H
+#define EVDASHWEBSOCKETSERVER_H
+
+#include <QHash>
+#include <QHostAddress>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QSslConfiguration>
+#include <QWebSocketProtocol>
+
+class QThread;
+class EvDashTcpServer;
+class EvDashTlsSessionCache;
+class EvDashTracer;
+class EvDashWebSocketWorker;
+
+// WebSocket server of the EV Dash engine. Accepts connections on the engine
+// thread and distributes them round robin to a set of worker threads which
+// own the sockets. Clients are identified by an id, all signals are delivered
+// in the engine thread.
+class EvDashWebSocketServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EvDashWebSocketServer(QObject *parent = nullptr);
+    ~EvDashWebSocketServer() override;
+
+    // Configuration, takes effect on the next listen()
+    void setWorkerCount(int workerCount);
+    bool setSslConfiguration(const QSslConfiguration &sslConfiguration, bool sessionCache = true);
+    void setHeartbeat(int pingInterval, int pongTimeout);
+    void setConnectionLimits(int maxClients, int maxClientsPerAddress);
+    void setTracer(EvDashTracer *tracer);
+
+    bool listen(const QHostAddress &address, quint16 port);
+    void close();
+
+    bool isListening() const;
+    bool sslEnabled() const;
+    QHostAddress serverAddress() const;
+    quint16 serverPort() const;
+    QString errorString() const;
+
+    int workerCount() const;
+    int queueDepth() const;
+    EvDashTlsSessionCache *tlsSessionCache() const;
+
+    QHostAddress peerAddress(quint64 clientId) const;
+
+    void sendTextMessage(quint64 clientId, const QByteArray &message, const QString &traceId = QString());
+    void sendTextMessage(const QList<quint64> &clientIds, const QByteArray &message, const QString &traceId = QString());
+    void closeClient(quint64 clientId, QWebSocketProtocol::CloseCode closeCode, const QString &reason);
+
+signals:
+    void clientConnected(quint64 clientId);
+    void clientDisconnected(quint64 clientId);
+    void requestReceived(quint64 clientId, const QJsonObject &request);
+    void invalidRequestReceived(quint64 clientId, const QString &errorString);
+
+private:
+    struct ClientInfo
+    {
+        int worker = 0;
+        QHostAddress peerAddress;
+        bool connected = false;
+    };
+
+    EvDashTcpServer *m_tcpServer = nullptr;
+    QList<QThread *> m_threads;
+    QList<EvDashWebSocketWorker *> m_workers;
+    int m_workerCount = 1;
+    int m_nextWorker = 0;
+
+    QSslConfiguration m_sslConfiguration;
+    EvDashTlsSessionCache *m_tlsSessionCache = nullptr;
+    int m_pingInterval = 30000;
+    int m_pongTimeout = 10000;
+    int m_maxClients = 64;
+    int m_maxClientsPerAddress = 8;
+    EvDashTracer *m_tracer = nullptr;
+
+    QHash<quint64, ClientInfo> m_clients;
+    QHash<QHostAddress, int> m_clientsPerAddress;
+    quint64 m_nextClientId = 1;
+
+    void startWorkers();
+    void stopWorkers();
+
+    void onConnectionAvailable(qintptr socketDescriptor);
+    void onClientConnected(quint64 clientId);
+    void onClientDisconnected(quint64 clientId);
+};
+
+#endif // EVDASHWEBSOCKETSERVER_H
@@ -0,0 +1,293 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "evdashwebsocketworker.h"
+#include "evdashtlssessioncache.h"
+#include "evdashtracer.h"
+
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QSslSocket>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+#include <QWebSocket>
+#include <QWebSocketServer>
+
+#include <QLoggingCategory>
+Q_DECLARE_LOGGING_CATEGORY(dcEvDashExperience)
+
+EvDashWebSocketWorker::EvDashWebSocketWorker(int index, QObject *parent)
+    : QObject{parent}
+    , m_index{index}
+{
+    // Never listens, only used to upgrade the sockets handed over by the engine thread
+    m_webSocketServer = new QWebSocketServer(QStringLiteral("EvDashEngine"), QWebSocketServer::NonSecureMode, this);
+    connect(m_webSocketServer, &QWebSocketServer::newConnection, this, &EvDashWebSocketWorker::onNewConnection);
+    connect(m_webSocketServer, &QWebSocketServer::serverError, this, [](QWebSocketProtocol::CloseCode closeCode) {
+        qCWarning(dcEvDashExperience()) << "WebSocket upgrade failed" << closeCode;
+    });
+
+    m_clock.start();
+    m_heartbeatTimer = new QTimer(this);
+    connect(m_heartbeatTimer, &QTimer::timeout, this, &EvDashWebSocketWorker::onHeartbeatTimeout);
+}
+
+EvDashWebSocketWorker::~EvDashWebSocketWorker()
+{
+    closeAll();
+}
+
+void EvDashWebSocketWorker::setSslConfiguration(const QSslConfiguration &sslConfiguration, EvDashTlsSessionCache *sessionCache)
+{
+    m_sslEnabled = !sslConfiguration.isNull();
+    m_sslConfiguration = sslConfiguration;
+    m_sessionCache = sessionCache;
+}
+
+void EvDashWebSocketWorker::setHeartbeat(int pingInterval, int pongTimeout)
+{
+    m_heartbeatTimer->setInterval(pingInterval);
+    m_pongTimeout = pongTimeout;
+}
+
+void EvDashWebSocketWorker::setTracer(EvDashTracer *tracer)
+{
+    m_tracer = tracer;
+}
+
+void EvDashWebSocketWorker::enqueueFrame(const EvDashFrame &frame)
+{
+    m_frameQueue.push(frame);
+
+    // Wake the worker only once for a burst of frames
+    if (m_processFramesScheduled.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "processFrames", Qt::QueuedConnection);
+}
+
+int EvDashWebSocketWorker::queueDepth() const
+{
+    return m_frameQueue.size();
+}
+
+void EvDashWebSocketWorker::addConnection(quint64 clientId, qintptr socketDescriptor)
+{
+    QTcpSocket *socket = nullptr;
+    if (m_sslEnabled) {
+        socket = new QSslSocket(this);
+    } else {
+        socket = new QTcpSocket(this);
+    }
+
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        qCWarning(dcEvDashExperience()) << "Failed to set up socket for incoming connection" << socket->errorString();
+        delete socket;
+        emit clientDisconnected(clientId);
+        return;
+    }
+
+    const PeerKey peer(socket->peerAddress(), socket->peerPort());
+    m_pendingClients.insert(peer, clientId);
+
+    // Clean up if the TLS or WebSocket handshake never completes
+    connect(socket, &QTcpSocket::disconnected, this, [this, peer]() {
+        if (m_pendingClients.contains(peer))
+            emit clientDisconnected(m_pendingClients.take(peer));
+    });
+
+    if (m_sslEnabled) {
+        QSslSocket *sslSocket = static_cast<QSslSocket *>(socket);
+        connect(sslSocket, QOverload<const QList<QSslError> &>::of(&QSslSocket::sslErrors), this, [sslSocket](const QList<QSslError> &errors) {
+            qCWarning(dcEvDashExperience()) << "TLS handshake with" << sslSocket->peerAddress().toString() << "failed:" << errors;
+        });
+
+        sslSocket->setSslConfiguration(m_sslConfiguration);
+        sslSocket->startServerEncryption();
+
+        // Must happen before the event loop delivers the client hello
+        if (m_sessionCache)
+            m_sessionCache->attach(sslSocket);
+    }
+
+    m_webSocketServer->handleConnection(socket);
+
+    if (!m_heartbeatTimer->isActive())
+        m_heartbeatTimer->start();
+}
+
+void EvDashWebSocketWorker::closeConnection(quint64 clientId, int closeCode, const QString &reason)
+{
+    QWebSocket *socket = m_clients.value(clientId);
+    if (!socket)
+        return;
+
+    socket->close(static_cast<QWebSocketProtocol::CloseCode>(closeCode), reason);
+}
+
+void EvDashWebSocketWorker::closeAll()
+{
+    m_heartbeatTimer->stop();
+
+    for (auto it = m_clients.constBegin(); it != m_clients.constEnd(); ++it) {
+        QWebSocket *socket = it.value();
+        socket->disconnect(this);
+        if (socket->state() == QAbstractSocket::ConnectedState)
+            socket->close(QWebSocketProtocol::CloseCodeGoingAway, QStringLiteral("Server shutting down"));
+
+        socket->deleteLater();
+    }
+
+    m_clients.clear();
+    m_clientsLastSeen.clear();
+    m_pendingClients.clear();
+
+    // Drop frames for the closed clients
+    EvDashFrame frame;
+    while (m_frameQueue.pop(&frame)) { }
+}
+
+void EvDashWebSocketWorker::processFrames()
+{
+    m_processFramesScheduled.fetchAndStoreOrdered(0);
+
+    EvDashFrame frame;
+    while (m_frameQueue.pop(&frame)) {
+        const bool traced = m_tracer && !frame.traceId.isEmpty();
+        const qint64 writeStart = traced ? EvDashTracer::now() : 0;
+
+        if (frame.binary) {
+            for (quint64 clientId : qAsConst(frame.clientIds)) {
+                QWebSocket *socket = m_clients.value(clientId);
+                if (socket)
+                    socket->sendBinaryMessage(frame.payload);
+            }
+        } else {
+            // Decode once for all recipients of this shard
+            const QString message = QString::fromUtf8(frame.payload);
+            for (quint64 clientId : qAsConst(frame.clientIds)) {
+                QWebSocket *socket = m_clients.value(clientId);
+                if (socket)
+                    socket->sendTextMessage(message);
+            }
+        }
+
+        if (traced) {
+            QVariantMap args;
+            args.insert("worker", m_index);
+            args.insert("clients", frame.clientIds.count());
+            args.insert("bytes", frame.payload.size());
+            m_tracer->addSpan(frame.traceId, QStringLiteral("write"), writeStart, EvDashTracer::now(), args);
+        }
+    }
+}
+
+void EvDashWebSocketWorker::onNewConnection()
+{
+    while (QWebSocket *socket = m_webSocketServer->nextPendingConnection()) {
+        const PeerKey peer(socket->peerAddress(), socket->peerPort());
+        if (!m_pendingClients.contains(peer)) {
+            qCWarning(dcEvDashExperience()) << "Received WebSocket connection from unknown peer" << socket->peerAddress().toString();
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+
+        setupClient(m_pendingClients.take(peer), socket);
+    }
+}
+
+void EvDashWebSocketWorker::setupClient(quint64 clientId, QWebSocket *socket)
+{
+    connect(socket, &QWebSocket::textMessageReceived, this, [this, clientId, socket](const QString &message) {
+        m_clientsLastSeen[socket] = m_clock.elapsed();
+        const qint64 parseStart = m_tracer ? EvDashTracer::now() : 0;
+
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8(), &parseError);
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+            emit invalidRequestReceived(clientId, parseError.errorString());
+            return;
+        }
+
+        const QJsonObject request = doc.object();
+        if (m_tracer) {
+            const QString requestId = request.value("requestId").toString();
+            if (!requestId.isEmpty()) {
+                QVariantMap args;
+                args.insert("worker", m_index);
+                args.insert("bytes", message.size());
+                m_tracer->addSpan(EvDashTracer::requestTraceId(clientId, requestId), QStringLiteral("parse"), parseStart, EvDashTracer::now(), args);
+            }
+        }
+
+        emit requestReceived(clientId, request);
+    });
+
+    connect(socket, &QWebSocket::pong, this, [this, socket](quint64 elapsedTime, const QByteArray &payload) {
+        Q_UNUSED(elapsedTime)
+        Q_UNUSED(payload)
+        m_clientsLastSeen[socket] = m_clock.elapsed();
+    });
+
+    connect(socket, &QWebSocket::disconnected, this, [this, clientId, socket]() {
+        m_clients.remove(clientId);
+        m_clientsLastSeen.remove(socket);
+        socket->deleteLater();
+        emit clientDisconnected(clientId);
+    });
+
+    m_clients.insert(clientId, socket);
+    m_clientsLastSeen.insert(socket, m_clock.elapsed());
+    qCDebug(dcEvDashExperience()) << "WebSocket client" << clientId << "connected on worker" << m_index << socket->peerAddress().toString();
+    emit clientConnected(clientId);
+}
+
+void EvDashWebSocketWorker::onHeartbeatTimeout()
+{
+    if (m_clients.isEmpty() && m_pendingClients.isEmpty()) {
+        m_heartbeatTimer->stop();
+        return;
+    }
+
+    // Each reap checks against its own ping, a later ping must not count as unanswered
+    const qint64 pingSent = m_clock.elapsed();
+    for (QWebSocket *socket : qAsConst(m_clients))
+        socket->ping();
+
+    QTimer::singleShot(m_pongTimeout, this, [this, pingSent]() { reapUnresponsiveClients(pingSent); });
+}
+
+void EvDashWebSocketWorker::reapUnresponsiveClients(qint64 pingSent)
+{
+    // Work on a copy, aborting a socket emits disconnected synchronously
+    const QList<QWebSocket *> sockets = m_clients.values();
+    for (QWebSocket *socket : sockets) {
+        if (m_clientsLastSeen.value(socket) >= pingSent)
+            continue;
+
+        qCDebug(dcEvDashExperience()) << "WebSocket client" << socket->peerAddress().toString() << "did not answer the ping in time. Dropping connection.";
+        socket->abort();
+    }
+}
@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef EVDASHWEBSOCKETWORKER_H
+#define EVDASHWEBSOCKETWORKER_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QJsonObject>
+#include <QObject>
+#include <QPair>
+#include <QSslConfiguration>
+
+#include "evdashframequeue.h"
+
+class QTimer;
+class QTcpSocket;
+class QWebSocket;
+class QWebSocketServer;
+class EvDashTlsSessionCache;
+class EvDashTracer;
+
+// Owns a shard of the WebSocket clients and lives in its own thread. TLS,
+// the WebSocket handshake, JSON parsing of incoming requests and frame writes
+// happen here. Requests are handed to the engine with queued signals, frames
+// from the engine arrive through a lock free queue.
+class EvDashWebSocketWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EvDashWebSocketWorker(int index, QObject *parent = nullptr);
+    ~EvDashWebSocketWorker() override;
+
+    // Must be called before the worker has been moved to its thread
+    void setSslConfiguration(const QSslConfiguration &sslConfiguration, EvDashTlsSessionCache *sessionCache);
+    void setHeartbeat(int pingInterval, int pongTimeout);
+    void setTracer(EvDashTracer *tracer);
+
+    // Thread safe, called from the engine thread
+    void enqueueFrame(const EvDashFrame &frame);
+    int queueDepth() const;
+
+public slots:
+    void addConnection(quint64 clientId, qintptr socketDescriptor);
+    void closeConnection(quint64 clientId, int closeCode, const QString &reason);
+    void closeAll();
+
+signals:
+    void clientConnected(quint64 clientId);
+    void clientDisconnected(quint64 clientId);
+    void requestReceived(quint64 clientId, const QJsonObject &request);
+    void invalidRequestReceived(quint64 clientId, const QString &errorString);
+
+private slots:
+    void processFrames();
+    void onNewConnection();
+    void onHeartbeatTimeout();
+    void reapUnresponsiveClients(qint64 pingSent);
+
+private:
+    typedef QPair<QHostAddress, quint16> PeerKey;
+
+    int m_index = 0;
+    QWebSocketServer *m_webSocketServer = nullptr;
+
+    bool m_sslEnabled = false;
+    QSslConfiguration m_sslConfiguration;
+    EvDashTlsSessionCache *m_sessionCache = nullptr;
+    EvDashTracer *m_tracer = nullptr;
+
+    // Sockets waiting for the TLS and WebSocket handshake, keyed by peer
+    QHash<PeerKey, quint64> m_pendingClients;
+    QHash<quint64, QWebSocket *> m_clients;
+
+    EvDashFrameQueue<EvDashFrame> m_frameQueue;
+    QAtomicInt m_processFramesScheduled{0};
+
+    // Heartbeat, all intervals in milliseconds
+    QTimer *m_heartbeatTimer = nullptr;
+    QElapsedTimer m_clock;
+    QHash<QWebSocket *, qint64> m_clientsLastSeen;
+    int m_pongTimeout = 10000;
+
+    void setupClient(quint64 clientId, QWebSocket *socket);
+};
+
+#endif // EVDASHWEBSOCKETWORKER_H
@@ -26,6 +26,8 @@
 
 #include "evdashengine.h"
 #include "evdashjsonhandler.h"
+#include "evdashsettingsstore.h"
+#include "evdashstatistics.h"
 #include "evdashwebserverresource.h"
 
 #include <jsonrpc/jsonrpcserver.h>
@@ -39,10 +41,13 @@ void ExperiencePluginEvDash::init()
 {
     qCDebug(dcEvDashExperience()) << "Initializing experience...";
 
-    m_resource = new EvDashWebServerResource(this);
-    m_engine = new EvDashEngine(thingManager(), logEngine(), m_resource, this);
+    m_settingsStore = new EvDashSettingsStore(this);
+    m_statistics = new EvDashStatistics(this);
+    m_resource = new EvDashWebServerResource(m_settingsStore, m_statistics, this);
+    m_engine = new EvDashEngine(thingManager(), logEngine(), m_resource, m_settingsStore, m_statistics, this);
+    m_resource->setEngine(m_engine);
 
-    jsonRpcServer()->registerExperienceHandler(new EvDashJsonHandler(m_engine, m_resource, this), 1, 0);
+    jsonRpcServer()->registerExperienceHandler(new EvDashJsonHandler(m_engine, m_resource, m_statistics, this), 1, 0);
 }
 
 WebServerResource *ExperiencePluginEvDash::webServerResource() const
@@ -32,6 +32,8 @@
 Q_DECLARE_LOGGING_CATEGORY(dcEvDashExperience)
 
 class EvDashEngine;
+class EvDashSettingsStore;
+class EvDashStatistics;
 class EvDashWebServerResource;
 
 class ExperiencePluginEvDash : public ExperiencePlugin
@@ -50,6 +52,8 @@ public:
 private:
     EvDashEngine *m_engine = nullptr;
     EvDashWebServerResource *m_resource = nullptr;
+    EvDashStatistics *m_statistics = nullptr;
+    EvDashSettingsStore *m_settingsStore = nullptr;
 };
 
 #endif // EXPERIENCEPLUGINEVDASH_H
@@ -4,7 +4,7 @@ TARGET = $$qtLibraryTarget(nymea_experiencepluginevdash)
 include(../config.pri)
 
 CONFIG += plugin link_pkgconfig
-PKGCONFIG += nymea
+PKGCONFIG += nymea openssl
 
 RESOURCES += ../dashboard.qrc
 
@@ -14,18 +14,36 @@ QT += network websockets dbus
 HEADERS += experiencepluginevdash.h \
     energymanagerdbusclient.h \
     chargingsessionsdbusinterfaceclient.h \
+    evdashchargerfields.h \
     evdashengine.h \
     evdashjsonhandler.h \
+    evdashframequeue.h \
+    evdashsessionstore.h \
     evdashsettings.h \
-    evdashwebserverresource.h
+    evdashsettingsstore.h \
+    evdashstatistics.h \
+    evdashtcpserver.h \
+    evdashtlssessioncache.h \
+    evdashtracer.h \
+    evdashwebserverresource.h \
+    evdashwebsocketserver.h \
+    evdashwebsocketworker.h
 
 SOURCES += experiencepluginevdash.cpp \
     energymanagerdbusclient.cpp \
     chargingsessionsdbusinterfaceclient.cpp \
     evdashengine.cpp \
     evdashjsonhandler.cpp \
+    evdashsessionstore.cpp \
     evdashsettings.cpp \
-    evdashwebserverresource.cpp
+    evdashsettingsstore.cpp \
+    evdashstatistics.cpp \
+    evdashtcpserver.cpp \
+    evdashtlssessioncache.cpp \
+    evdashtracer.cpp \
+    evdashwebserverresource.cpp \
+    evdashwebsocketserver.cpp \
+    evdashwebsocketworker.cpp
 
 target.path = $$[QT_INSTALL_LIBS]/nymea/experiences/
 INSTALLS += target
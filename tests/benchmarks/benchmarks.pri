@@ -0,0 +1,14 @@
+include(../../config.pri)
+
+CONFIG += console
+CONFIG -= app_bundle
+
+QT -= gui
+QT += testlib
+
+INCLUDEPATH += $$top_srcdir/plugin
+
+# make benchmark: run the benchmark and write machine readable QtTest XML results next to the binary
+benchmark.commands = ./$$TARGET -o $${TARGET}.xml,xml -o -,txt
+benchmark.depends = $$TARGET
+QMAKE_EXTRA_TARGETS += benchmark
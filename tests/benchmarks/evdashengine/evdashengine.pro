@@ -0,0 +1,37 @@
+TEMPLATE = app
+TARGET = evdashengine
+
+include(../benchmarks.pri)
+include(../mocks/mocks.pri)
+
+CONFIG += link_pkgconfig
+PKGCONFIG += openssl
+
+QT += network websockets
+
+HEADERS += $$top_srcdir/plugin/evdashchargerfields.h \
+    $$top_srcdir/plugin/evdashengine.h \
+    $$top_srcdir/plugin/evdashframequeue.h \
+    $$top_srcdir/plugin/evdashsessionstore.h \
+    $$top_srcdir/plugin/evdashsettings.h \
+    $$top_srcdir/plugin/evdashsettingsstore.h \
+    $$top_srcdir/plugin/evdashstatistics.h \
+    $$top_srcdir/plugin/evdashtcpserver.h \
+    $$top_srcdir/plugin/evdashtlssessioncache.h \
+    $$top_srcdir/plugin/evdashtracer.h \
+    $$top_srcdir/plugin/evdashwebserverresource.h \
+    $$top_srcdir/plugin/evdashwebsocketserver.h \
+    $$top_srcdir/plugin/evdashwebsocketworker.h
+
+SOURCES += evdashenginebenchmark.cpp \
+    $$top_srcdir/plugin/evdashengine.cpp \
+    $$top_srcdir/plugin/evdashsessionstore.cpp \
+    $$top_srcdir/plugin/evdashsettings.cpp \
+    $$top_srcdir/plugin/evdashsettingsstore.cpp \
+    $$top_srcdir/plugin/evdashstatistics.cpp \
+    $$top_srcdir/plugin/evdashtcpserver.cpp \
+    $$top_srcdir/plugin/evdashtlssessioncache.cpp \
+    $$top_srcdir/plugin/evdashtracer.cpp \
+    $$top_srcdir/plugin/evdashwebserverresource.cpp \
+    $$top_srcdir/plugin/evdashwebsocketserver.cpp \
+    $$top_srcdir/plugin/evdashwebsocketworker.cpp
@@ -0,0 +1,459 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+
+#include "energymanagerdbusclient.h"
+#include "evdashengine.h"
+#include "evdashsessionstore.h"
+#include "evdashsettings.h"
+#include "evdashsettingsstore.h"
+#include "evdashstatistics.h"
+#include "evdashwebserverresource.h"
+#include "evdashwebsocketserver.h"
+
+#include <integrations/thingmanager.h>
+#include <logging/logengine.h>
+#include <nymeasettings.h>
+
+#include <QJsonArray>
+#include <QTemporaryDir>
+#include <QWebSocket>
+#include <QtTest>
+
+Q_LOGGING_CATEGORY(dcEvDashExperience, "EvDashExperience", QtWarningMsg)
+
+static StateTypes chargerStateTypes()
+{
+    StateTypes stateTypes;
+    const QStringList stateNames = {"connected", "maxChargingCurrent", "currentPower", "pluggedIn", "power", "currentVersion",
+                                    "sessionEnergy", "desiredPhaseCount", "temperature", "error", "status", "digitalInputMode"};
+    for (const QString &stateName : stateNames)
+        stateTypes.append(StateType(StateTypeId::createStateTypeId(), stateName));
+
+    return stateTypes;
+}
+
+// Benchmarks the hot paths of the EV Dash engine against mocked nymea core
+// objects. Notifications are delivered to real WebSocket clients on localhost.
+class EvDashEngineBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void packCharger_data();
+    void packCharger();
+
+    void sendNotification_data();
+    void sendNotification();
+
+    void onSessionsReceived_data();
+    void onSessionsReceived();
+
+    void getChargers_data();
+    void getChargers();
+
+    void getSnapshot_data();
+    void getSnapshot();
+
+    void getChargingSessions_data();
+    void getChargingSessions();
+
+    void validateToken_data();
+    void validateToken();
+
+private:
+    QTemporaryDir m_settingsDir;
+    EvDashSettingsStore *m_settingsStore = nullptr;
+    EvDashStatistics *m_statistics = nullptr;
+    ThingManager *m_thingManager = nullptr;
+    LogEngine *m_logEngine = nullptr;
+    EvDashWebServerResource *m_resource = nullptr;
+    EvDashEngine *m_engine = nullptr;
+
+    ThingClass m_chargerThingClass{ThingClassId::createUuid(), {QStringLiteral("evcharger")}, ActionTypes(), chargerStateTypes()};
+    ThingClass m_carThingClass{ThingClassId::createUuid(), {QStringLiteral("electricvehicle")}};
+    QList<Thing *> m_chargers;
+    QList<Thing *> m_cars;
+    QList<QWebSocket *> m_webSockets;
+
+    void setChargerCount(int count);
+    void connectClients(int count);
+    void waitForQueuesDrained();
+};
+
+void EvDashEngineBenchmark::initTestCase()
+{
+    QVERIFY(m_settingsDir.isValid());
+    NymeaSettings::setSettingsPath(m_settingsDir.path());
+
+    // Listen on a random port and never drop the benchmark clients
+    EvDashSettings settings;
+    settings.beginGroup("General");
+    settings.setValue("enabled", true);
+    settings.setValue("webSocketServerPort", 0);
+    settings.endGroup();
+    settings.beginGroup("WebSocket");
+    settings.setValue("workerThreads", 2);
+    settings.setValue("maxClients", 1000);
+    settings.setValue("maxClientsPerAddress", 1000);
+    settings.setValue("authenticationTimeout", 3600000);
+    settings.endGroup();
+    settings.sync();
+
+    m_settingsStore = new EvDashSettingsStore(this);
+    m_statistics = new EvDashStatistics(this);
+    m_thingManager = new ThingManager(this);
+    m_logEngine = new LogEngine(this);
+    m_resource = new EvDashWebServerResource(m_settingsStore, m_statistics, this);
+    m_engine = new EvDashEngine(m_thingManager, m_logEngine, m_resource, m_settingsStore, m_statistics, this);
+
+    QVERIFY(m_engine->enabled());
+    QVERIFY(m_engine->m_webSocketServer->isListening());
+}
+
+void EvDashEngineBenchmark::cleanupTestCase()
+{
+    qDeleteAll(m_webSockets);
+    m_webSockets.clear();
+
+    delete m_engine;
+    m_engine = nullptr;
+}
+
+void EvDashEngineBenchmark::packCharger_data()
+{
+    QTest::addColumn<int>("chargers");
+
+    QTest::newRow("1-charger") << 1;
+    QTest::newRow("100-chargers") << 100;
+}
+
+void EvDashEngineBenchmark::packCharger()
+{
+    QFETCH(int, chargers);
+
+    // Packing scans the charging infos of all chargers
+    setChargerCount(chargers);
+    Thing *charger = m_chargers.last();
+
+    QBENCHMARK {
+        const QJsonObject chargerObject = m_engine->packCharger(charger);
+        Q_UNUSED(chargerObject)
+    }
+}
+
+void EvDashEngineBenchmark::sendNotification_data()
+{
+    QTest::addColumn<int>("clients");
+    QTest::addColumn<int>("chargers");
+
+    QList<int> clientCounts = {1, 10, 100};
+    QList<int> chargerCounts = {1, 10};
+    for (int clients : clientCounts) {
+        for (int chargers : chargerCounts) {
+            QTest::addRow("%d-clients-%d-chargers", clients, chargers) << clients << chargers;
+        }
+    }
+}
+
+void EvDashEngineBenchmark::sendNotification()
+{
+    QFETCH(int, clients);
+    QFETCH(int, chargers);
+
+    setChargerCount(chargers);
+    connectClients(clients);
+    if (QTest::currentTestFailed())
+        return;
+
+    QBENCHMARK {
+        for (Thing *charger : qAsConst(m_chargers)) {
+            m_engine->sendNotification(QStringLiteral("ChargerChanged"), m_engine->packCharger(charger));
+        }
+    }
+
+    waitForQueuesDrained();
+}
+
+void EvDashEngineBenchmark::onSessionsReceived_data()
+{
+    QTest::addColumn<int>("sessions");
+
+    QTest::newRow("1k-sessions") << 1000;
+    QTest::newRow("10k-sessions") << 10000;
+}
+
+void EvDashEngineBenchmark::onSessionsReceived()
+{
+    QFETCH(int, sessions);
+
+    connectClients(10);
+    if (QTest::currentTestFailed())
+        return;
+
+    const QDateTime start = QDateTime::currentDateTimeUtc().addDays(-365);
+    QList<QVariantMap> sessionList;
+    for (int i = 0; i < sessions; i++) {
+        QVariantMap session;
+        session.insert("sessionId", i);
+        session.insert("carId", QUuid::createUuid().toString(QUuid::WithoutBraces));
+        session.insert("carName", QStringLiteral("Car %1").arg(i % 20));
+        session.insert("evChargerId", QUuid::createUuid().toString(QUuid::WithoutBraces));
+        session.insert("evChargerName", QStringLiteral("Charger %1").arg(i % 10));
+        session.insert("startTimestamp", start.addSecs(i * 3600).toSecsSinceEpoch());
+        session.insert("endTimestamp", start.addSecs(i * 3600 + 1800).toSecsSinceEpoch());
+        session.insert("sessionEnergy", 12.5 + (i % 40));
+        session.insert("energyStart", 1000.0 + i * 12.5);
+        session.insert("energyEnd", 1012.5 + i * 12.5);
+        sessionList.append(session);
+    }
+
+    QBENCHMARK {
+        m_engine->onSessionsReceived(sessionList, QStringList());
+    }
+
+    waitForQueuesDrained();
+}
+
+void EvDashEngineBenchmark::getChargers_data()
+{
+    QTest::addColumn<int>("chargers");
+
+    QTest::newRow("10-chargers") << 10;
+    QTest::newRow("100-chargers") << 100;
+}
+
+void EvDashEngineBenchmark::getChargers()
+{
+    QFETCH(int, chargers);
+
+    setChargerCount(chargers);
+
+    QJsonObject request;
+    request.insert("requestId", QStringLiteral("benchmark"));
+    request.insert("action", QStringLiteral("GetChargers"));
+
+    QBENCHMARK {
+        const QJsonObject response = m_engine->handleApiRequest(0, request);
+        Q_UNUSED(response)
+    }
+}
+
+void EvDashEngineBenchmark::getSnapshot_data()
+{
+    QTest::addColumn<int>("chargers");
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("100-chargers-cached") << 100 << true;
+    QTest::newRow("100-chargers-rebuild") << 100 << false;
+}
+
+void EvDashEngineBenchmark::getSnapshot()
+{
+    QFETCH(int, chargers);
+    QFETCH(bool, cached);
+
+    setChargerCount(chargers);
+
+    QBENCHMARK {
+        if (!cached)
+            m_engine->m_stateVersion++;
+
+        const QByteArray reply = m_engine->createSnapshotReply(QStringLiteral("benchmark"));
+        Q_UNUSED(reply)
+    }
+}
+
+void EvDashEngineBenchmark::getChargingSessions_data()
+{
+    QTest::addColumn<bool>("filtered");
+    QTest::addColumn<bool>("summary");
+
+    QTest::newRow("all-cars") << false << false;
+    QTest::newRow("one-car") << true << false;
+    QTest::newRow("all-cars-summary") << false << true;
+    QTest::newRow("one-car-summary") << true << true;
+}
+
+void EvDashEngineBenchmark::getChargingSessions()
+{
+    QFETCH(bool, filtered);
+    QFETCH(bool, summary);
+
+    QVERIFY(m_engine->m_sessionStore);
+
+    // 10k sessions of 20 cars, answered from the session store
+    static const QString carId = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    static bool storeFilled = false;
+    if (!storeFilled) {
+        const QDateTime start = QDateTime::currentDateTimeUtc().addDays(-365);
+        QList<QVariantMap> sessionList;
+        for (int i = 0; i < 10000; i++) {
+            QVariantMap session;
+            session.insert("sessionId", QStringLiteral("query-%1").arg(i));
+            session.insert("carId", i % 20 == 0 ? carId : QUuid::createUuid().toString(QUuid::WithoutBraces));
+            session.insert("startTimestamp", start.addSecs(i * 3600).toSecsSinceEpoch());
+            session.insert("endTimestamp", start.addSecs(i * 3600 + 1800).toSecsSinceEpoch());
+            session.insert("sessionEnergy", 12.5 + (i % 40));
+            sessionList.append(session);
+        }
+
+        m_engine->onSessionsReceived(sessionList, QStringList());
+        storeFilled = true;
+    }
+
+    // Count and energy sum straight from the store index
+    if (summary) {
+        const QStringList carIds = filtered ? QStringList{carId} : QStringList();
+        QBENCHMARK {
+            const EvDashSessionStore::Summary storeSummary = m_engine->m_sessionStore->summary(carIds);
+            Q_UNUSED(storeSummary)
+        }
+        return;
+    }
+
+    QJsonObject request;
+    request.insert("requestId", QStringLiteral("benchmark"));
+    request.insert("action", QStringLiteral("GetChargingSessions"));
+    if (filtered)
+        request.insert("payload", QJsonObject{{"carId", carId}});
+
+    QBENCHMARK {
+        const QJsonObject response = m_engine->handleApiRequest(0, request);
+        Q_UNUSED(response)
+    }
+
+    waitForQueuesDrained();
+}
+
+void EvDashEngineBenchmark::validateToken_data()
+{
+    QTest::addColumn<int>("tokens");
+
+    QTest::newRow("10-tokens") << 10;
+    QTest::newRow("1k-tokens") << 1000;
+    QTest::newRow("10k-tokens") << 10000;
+}
+
+void EvDashEngineBenchmark::validateToken()
+{
+    QFETCH(int, tokens);
+
+    m_resource->m_activeTokens.clear();
+
+    QString token;
+    for (int i = 0; i < tokens; i++) {
+        EvDashWebServerResource::TokenInfo info;
+        info.username = QStringLiteral("benchmark");
+        info.expiresAt = QDateTime::currentDateTimeUtc().addSecs(EvDashWebServerResource::s_tokenLifetimeSeconds);
+        token = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        m_resource->m_activeTokens.insert(token, info);
+    }
+
+    bool valid = false;
+    QBENCHMARK {
+        valid = m_resource->validateToken(token);
+    }
+
+    QVERIFY(valid);
+}
+
+void EvDashEngineBenchmark::setChargerCount(int count)
+{
+    while (m_chargers.count() > count) {
+        Thing *charger = m_chargers.takeLast();
+        Thing *car = m_cars.takeLast();
+        QMetaObject::invokeMethod(m_engine->m_energyManagerClient, "onChargingInfoRemoved", Q_ARG(QString, charger->id().toString(QUuid::WithoutBraces)));
+        m_thingManager->removeThing(charger);
+        m_thingManager->removeThing(car);
+        delete charger;
+        delete car;
+    }
+
+    while (m_chargers.count() < count) {
+        const int index = m_chargers.count();
+
+        Thing *car = new Thing(m_carThingClass, QStringLiteral("Car %1").arg(index), this);
+        Thing *charger = new Thing(m_chargerThingClass, QStringLiteral("Charger %1").arg(index), this);
+        charger->setStateValue("connected", true);
+        charger->setStateValue("maxChargingCurrent", 16.0);
+        charger->setStateValue("currentPower", 7400.0);
+        charger->setStateValue("pluggedIn", true);
+        charger->setStateValue("power", true);
+        charger->setStateValue("currentVersion", 1.4);
+        charger->setStateValue("sessionEnergy", 12.3);
+        charger->setStateValue("desiredPhaseCount", 3);
+        charger->setStateValue("temperature", 31.5);
+        charger->setStateValue("error", QStringLiteral("None"));
+        charger->setStateValue("status", QStringLiteral("Charging"));
+        charger->setStateValue("digitalInputMode", 0);
+
+        m_thingManager->addThing(car);
+        m_thingManager->addThing(charger);
+        m_cars.append(car);
+        m_chargers.append(charger);
+
+        QVariantMap chargingInfo;
+        chargingInfo.insert("evChargerId", charger->id().toString(QUuid::WithoutBraces));
+        chargingInfo.insert("assignedCarId", car->id().toString(QUuid::WithoutBraces));
+        chargingInfo.insert("chargingMode", 1);
+        QMetaObject::invokeMethod(m_engine->m_energyManagerClient, "onChargingInfoAdded", Q_ARG(QVariantMap, chargingInfo));
+    }
+
+    // Let the log fetch jobs of the new chargers finish
+    QCoreApplication::processEvents();
+    waitForQueuesDrained();
+}
+
+void EvDashEngineBenchmark::connectClients(int count)
+{
+    while (m_webSockets.count() > count)
+        delete m_webSockets.takeLast();
+
+    const QUrl url(QStringLiteral("ws://127.0.0.1:%1").arg(m_engine->m_webSocketServer->serverPort()));
+    while (m_webSockets.count() < count) {
+        QWebSocket *webSocket = new QWebSocket();
+        webSocket->open(url);
+        m_webSockets.append(webSocket);
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(m_engine->m_clients.count(), count, 10000);
+
+    // Skip the token handshake, every client receives the notifications
+    for (quint64 clientId : qAsConst(m_engine->m_clients))
+        m_engine->m_authenticatedClients.insert(clientId, QStringLiteral("benchmark"));
+}
+
+void EvDashEngineBenchmark::waitForQueuesDrained()
+{
+    QTRY_COMPARE_WITH_TIMEOUT(m_engine->m_webSocketServer->queueDepth(), 0, 30000);
+}
+
+QTEST_GUILESS_MAIN(EvDashEngineBenchmark)
+
+#include "evdashenginebenchmark.moc"
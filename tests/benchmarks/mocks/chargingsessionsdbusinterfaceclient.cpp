@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+// Benchmark implementation of the charging sessions client. Does not touch
+// the bus, every request is answered with an empty session list.
+
+#include "chargingsessionsdbusinterfaceclient.h"
+
+#include <QTimer>
+
+ChargingSessionsDBusInterfaceClient::ChargingSessionsDBusInterfaceClient(const QDBusConnection &connection, QObject *parent)
+    : QObject(parent)
+    , m_connection(connection)
+{
+    m_callClock.start();
+}
+
+ChargingSessionsDBusInterfaceClient::~ChargingSessionsDBusInterfaceClient() {}
+
+void ChargingSessionsDBusInterfaceClient::getSessions(const QStringList &carThingIds, qlonglong startTimestamp, qlonglong endTimestamp)
+{
+    Q_UNUSED(startTimestamp)
+    Q_UNUSED(endTimestamp)
+
+    QTimer::singleShot(0, this, [this, carThingIds]() {
+        emit callFinished(QStringLiteral("GetSessions"), 0, true);
+        emit sessionsReceived(QList<QVariantMap>(), carThingIds);
+    });
+}
+
+void ChargingSessionsDBusInterfaceClient::onCallFinished(QDBusPendingCallWatcher *watcher)
+{
+    Q_UNUSED(watcher)
+}
+
+void ChargingSessionsDBusInterfaceClient::onServiceRegistered(const QString &service)
+{
+    Q_UNUSED(service)
+}
+
+void ChargingSessionsDBusInterfaceClient::onServiceUnregistered(const QString &service)
+{
+    Q_UNUSED(service)
+}
+
+bool ChargingSessionsDBusInterfaceClient::ensureInterface()
+{
+    return false;
+}
@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+// Benchmark implementation of the energy manager client. Does not touch the
+// bus, charging infos are fed in through onChargingInfoAdded().
+
+#include "energymanagerdbusclient.h"
+
+EnergyManagerDbusClient::EnergyManagerDbusClient(const QDBusConnection &connection, QObject *parent)
+    : QObject(parent)
+    , m_connection(connection)
+{}
+
+EnergyManagerDbusClient::~EnergyManagerDbusClient() {}
+
+QVariantList EnergyManagerDbusClient::chargingInfos() const
+{
+    return m_chargingInfos;
+}
+
+bool EnergyManagerDbusClient::chargingInfosReceived() const
+{
+    return m_chargingInfosReceived;
+}
+
+void EnergyManagerDbusClient::refreshChargingInfos()
+{
+    m_chargingInfosReceived = true;
+    emit chargingInfosUpdated(m_chargingInfos);
+}
+
+void EnergyManagerDbusClient::onChargingInfoAdded(const QVariantMap &chargingInfo)
+{
+    m_chargingInfosReceived = true;
+    replaceOrAdd(chargingInfo);
+    emit chargingInfoAdded(chargingInfo);
+    emit chargingInfosUpdated(m_chargingInfos);
+}
+
+void EnergyManagerDbusClient::onChargingInfoRemoved(const QString &evChargerId)
+{
+    int index = indexOfInfo(evChargerId);
+    if (index >= 0) {
+        m_chargingInfos.removeAt(index);
+        emit chargingInfoRemoved(evChargerId);
+        emit chargingInfosUpdated(m_chargingInfos);
+    }
+}
+
+void EnergyManagerDbusClient::onChargingInfoChanged(const QVariantMap &chargingInfo)
+{
+    replaceOrAdd(chargingInfo);
+    emit chargingInfoChanged(chargingInfo);
+    emit chargingInfosUpdated(m_chargingInfos);
+}
+
+void EnergyManagerDbusClient::onServiceRegistered(const QString &service)
+{
+    Q_UNUSED(service)
+}
+
+void EnergyManagerDbusClient::onServiceUnregistered(const QString &service)
+{
+    Q_UNUSED(service)
+}
+
+int EnergyManagerDbusClient::indexOfInfo(const QString &evChargerId) const
+{
+    for (int i = 0; i < m_chargingInfos.count(); ++i) {
+        if (m_chargingInfos.at(i).toMap().value(QStringLiteral("evChargerId")).toString() == evChargerId)
+            return i;
+    }
+    return -1;
+}
+
+void EnergyManagerDbusClient::replaceOrAdd(const QVariantMap &chargingInfo)
+{
+    int index = indexOfInfo(chargingInfo.value(QStringLiteral("evChargerId")).toString());
+    if (index >= 0) {
+        m_chargingInfos[index] = chargingInfo;
+    } else {
+        m_chargingInfos.append(chargingInfo);
+    }
+}
+
+bool EnergyManagerDbusClient::setupInterface()
+{
+    return false;
+}
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef MOCK_THING_H
+#define MOCK_THING_H
+
+// Minimal stand-in for the nymea Thing used by the benchmarks
+
+#include "types/actiontype.h"
+#include "types/statetype.h"
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QUuid>
+#include <QVariant>
+
+typedef QUuid ThingId;
+typedef QUuid ThingClassId;
+
+class ThingClass
+{
+public:
+    ThingClass(const ThingClassId &id = ThingClassId(), const QStringList &interfaces = QStringList(), const ActionTypes &actionTypes = ActionTypes(), const StateTypes &stateTypes = StateTypes())
+        : m_id{id}
+        , m_interfaces{interfaces}
+        , m_actionTypes{actionTypes}
+        , m_stateTypes{stateTypes}
+    {}
+
+    ThingClassId id() const { return m_id; }
+    QStringList interfaces() const { return m_interfaces; }
+    ActionTypes actionTypes() const { return m_actionTypes; }
+    StateTypes stateTypes() const { return m_stateTypes; }
+
+private:
+    ThingClassId m_id;
+    QStringList m_interfaces;
+    ActionTypes m_actionTypes;
+    StateTypes m_stateTypes;
+};
+
+class Thing : public QObject
+{
+    Q_OBJECT
+public:
+    enum ThingError {
+        ThingErrorNoError,
+        ThingErrorThingNotFound,
+        ThingErrorActionTypeNotFound,
+        ThingErrorMissingParameter,
+        ThingErrorInvalidParameter,
+        ThingErrorHardwareNotAvailable,
+        ThingErrorHardwareFailure,
+        ThingErrorTimeout
+    };
+    Q_ENUM(ThingError)
+
+    Thing(const ThingClass &thingClass, const QString &name, QObject *parent = nullptr)
+        : QObject{parent}
+        , m_id{ThingId::createUuid()}
+        , m_thingClass{thingClass}
+        , m_name{name}
+    {}
+
+    ThingId id() const { return m_id; }
+    ThingClassId thingClassId() const { return m_thingClass.id(); }
+    ThingClass thingClass() const { return m_thingClass; }
+    QString name() const { return m_name; }
+
+    bool hasState(const QString &stateName) const { return m_states.contains(stateName); }
+    QVariant stateValue(const QString &stateName) const { return m_states.value(stateName); }
+    bool hasState(const StateTypeId &stateTypeId) const { return hasState(m_thingClass.stateTypes().findById(stateTypeId).name()); }
+    QVariant stateValue(const StateTypeId &stateTypeId) const { return stateValue(m_thingClass.stateTypes().findById(stateTypeId).name()); }
+
+    void setStateValue(const QString &stateName, const QVariant &value)
+    {
+        m_states.insert(stateName, value);
+        emit stateValueChanged(m_thingClass.stateTypes().findByName(stateName).id(), value, QVariant(), QVariant(), QVariantList());
+    }
+
+signals:
+    void stateValueChanged(const StateTypeId &stateTypeId, const QVariant &value, const QVariant &minValue, const QVariant &maxValue, const QVariantList &possibleValues);
+
+private:
+    ThingId m_id;
+    ThingClass m_thingClass;
+    QString m_name;
+    QHash<QString, QVariant> m_states;
+};
+
+class Things : public QList<Thing *>
+{
+public:
+    Things() = default;
+    Things(const QList<Thing *> &other)
+        : QList<Thing *>(other)
+    {}
+};
+
+#endif // MOCK_THING_H
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+
+#ifndef MOCK_THINGACTIONINFO_H
+#define MOCK_THINGACTIONINFO_H
+
+// Minimal stand-in for the nymea ThingActionInfo used by the benchmarks
+
+#include "integrations/thing.h"
+#include "types/action.h"
+
+#include <QObject>
+
+class ThingActionInfo : public QObject
+{
+    Q_OBJECT
+public:
+    ThingActionInfo(Thing *thing, const Action &action, QObject *parent = nullptr)
+        : QObject{parent}
+        , m_thing{thing}
+        , m_action{action}
+    {}
+
+    Thing *thing() const { return m_thing; }
+    Action action() const { return m_action; }
+
+    bool isFinished() const { return m_finished; }
+    Thing::ThingError status() const { return m_status; }
+    QString displayMessage() const { return m_displayMessage; }
+
+    void finish(Thing::ThingError status, const QString &displayMessage = QString())
+    {
+        m_finished = true;
+        m_status = status;
+        m_displayMessage = displayMessage;
+        emit finished();
+        deleteLater();
+    }
+
+signals:
+    void finished();
+
+private:
+    Thing *m_thing = nullptr;
+    Action m_action;
+    bool m_finished = false;
+    Thing::ThingError m_status = Thing::ThingErrorNoError;
+    QString m_displayMessage;
+};
+
+#endif // MOCK_THINGACTIONINFO_H
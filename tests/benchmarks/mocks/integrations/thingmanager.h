@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef MOCK_THINGMANAGER_H
+#define MOCK_THINGMANAGER_H
+
+// Minimal stand-in for the nymea ThingManager used by the benchmarks
+
+#include "integrations/thing.h"
+#include "integrations/thingactioninfo.h"
+
+#include <QObject>
+#include <QTimer>
+
+class ThingManager : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ThingManager(QObject *parent = nullptr)
+        : QObject{parent}
+    {}
+
+    Things configuredThings() const { return m_things; }
+
+    Thing *findConfiguredThing(const ThingId &id) const
+    {
+        for (Thing *thing : m_things) {
+            if (thing->id() == id)
+                return thing;
+        }
+        return nullptr;
+    }
+
+    // Writes the first param to the state named like the action
+    ThingActionInfo *executeAction(const Action &action)
+    {
+        Thing *thing = findConfiguredThing(action.thingId());
+        ThingActionInfo *info = new ThingActionInfo(thing, action, this);
+        QTimer::singleShot(0, info, [thing, action, info]() {
+            if (!thing) {
+                info->finish(Thing::ThingErrorThingNotFound);
+                return;
+            }
+
+            const ActionType actionType = thing->thingClass().actionTypes().findById(action.actionTypeId());
+            if (actionType.id().isNull()) {
+                info->finish(Thing::ThingErrorActionTypeNotFound);
+                return;
+            }
+
+            if (!action.params().isEmpty())
+                thing->setStateValue(actionType.name(), action.params().first().value());
+
+            info->finish(Thing::ThingErrorNoError);
+        });
+        return info;
+    }
+
+    void addThing(Thing *thing)
+    {
+        m_things.append(thing);
+        emit thingAdded(thing);
+    }
+
+    void removeThing(Thing *thing)
+    {
+        m_things.removeAll(thing);
+        emit thingRemoved(thing->id());
+    }
+
+signals:
+    void thingAdded(Thing *thing);
+    void thingRemoved(const ThingId &thingId);
+    void thingChanged(Thing *thing);
+
+private:
+    Things m_things;
+};
+
+#endif // MOCK_THINGMANAGER_H
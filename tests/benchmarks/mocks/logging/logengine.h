@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef MOCK_LOGENGINE_H
+#define MOCK_LOGENGINE_H
+
+// Minimal stand-in for the nymea LogEngine used by the benchmarks. Fetch jobs
+// finish asynchronously without any entries.
+
+#include <QDateTime>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+
+class Types
+{
+public:
+    enum SampleRate { SampleRateAny = 0, SampleRate1Min = 1, SampleRate15Mins = 15, SampleRate1Hour = 60, SampleRate3Hours = 180, SampleRate1Day = 1440 };
+};
+
+class LogEntry
+{
+public:
+    LogEntry(const QDateTime &timestamp = QDateTime(), const QVariantMap &values = QVariantMap())
+        : m_timestamp{timestamp}
+        , m_values{values}
+    {}
+
+    QDateTime timestamp() const { return m_timestamp; }
+    QVariantMap values() const { return m_values; }
+
+private:
+    QDateTime m_timestamp;
+    QVariantMap m_values;
+};
+
+typedef QList<LogEntry> LogEntries;
+
+class LogFetchJob : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogFetchJob(QObject *parent = nullptr)
+        : QObject{parent}
+    {
+        QTimer::singleShot(0, this, [this]() {
+            emit finished(LogEntries());
+            deleteLater();
+        });
+    }
+
+signals:
+    void finished(const LogEntries &entries);
+};
+
+class LogEngine : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogEngine(QObject *parent = nullptr)
+        : QObject{parent}
+    {}
+
+    LogFetchJob *fetchLogEntries(const QStringList &sources,
+                                 const QStringList &columns = QStringList(),
+                                 const QDateTime &startTime = QDateTime(),
+                                 const QDateTime &endTime = QDateTime(),
+                                 const QVariantMap &filter = QVariantMap(),
+                                 Types::SampleRate sampleRate = Types::SampleRateAny,
+                                 Qt::SortOrder sortOrder = Qt::AscendingOrder,
+                                 int offset = 0,
+                                 int limit = 0)
+    {
+        Q_UNUSED(sources)
+        Q_UNUSED(columns)
+        Q_UNUSED(startTime)
+        Q_UNUSED(endTime)
+        Q_UNUSED(filter)
+        Q_UNUSED(sampleRate)
+        Q_UNUSED(sortOrder)
+        Q_UNUSED(offset)
+        Q_UNUSED(limit)
+        return new LogFetchJob(this);
+    }
+};
+
+#endif // MOCK_LOGENGINE_H
@@ -0,0 +1,21 @@
+# Lightweight stand-ins for the nymea core and the DBus services, so the
+# engine can be benchmarked without a running nymead
+INCLUDEPATH += $$PWD
+
+QT += dbus
+
+HEADERS += $$PWD/integrations/thing.h \
+    $$PWD/integrations/thingactioninfo.h \
+    $$PWD/integrations/thingmanager.h \
+    $$PWD/logging/logengine.h \
+    $$PWD/nymeasettings.h \
+    $$PWD/types/action.h \
+    $$PWD/types/actiontype.h \
+    $$PWD/types/param.h \
+    $$PWD/types/statetype.h \
+    $$PWD/webserver/webserverresource.h \
+    $$top_srcdir/plugin/chargingsessionsdbusinterfaceclient.h \
+    $$top_srcdir/plugin/energymanagerdbusclient.h
+
+SOURCES += $$PWD/chargingsessionsdbusinterfaceclient.cpp \
+    $$PWD/energymanagerdbusclient.cpp
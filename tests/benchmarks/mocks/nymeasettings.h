@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef MOCK_NYMEASETTINGS_H
+#define MOCK_NYMEASETTINGS_H
+
+// Minimal stand-in for the nymea settings. All files end up in the directory
+// set with setSettingsPath(), which defaults to a folder in the temp path.
+
+#include <QDir>
+#include <QSettings>
+
+class NymeaSettings : public QSettings
+{
+public:
+    enum SettingsRole { SettingsRoleNone, SettingsRoleGlobal, SettingsRoleThings, SettingsRoleRules, SettingsRolePlugins, SettingsRoleTags, SettingsRoleMqttPolicies, SettingsRoleIOConnections, SettingsRoleZigbee, SettingsRoleModbusRtu };
+
+    explicit NymeaSettings(const SettingsRole &role = SettingsRoleNone)
+        : QSettings(settingsPath() + (role == SettingsRoleGlobal ? "/nymead.conf" : "/other.conf"), QSettings::IniFormat)
+    {}
+
+    static QString settingsPath() { return settingsPathStorage(); }
+    static void setSettingsPath(const QString &path) { settingsPathStorage() = path; }
+    static QString storagePath() { return settingsPathStorage(); }
+
+private:
+    static QString &settingsPathStorage()
+    {
+        static QString path = QDir::tempPath() + "/evdash-benchmarks";
+        return path;
+    }
+};
+
+#endif // MOCK_NYMEASETTINGS_H
@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+
+#ifndef MOCK_ACTION_H
+#define MOCK_ACTION_H
+
+// Minimal stand-in for the nymea Action used by the benchmarks
+
+#include "integrations/thing.h"
+#include "types/actiontype.h"
+#include "types/param.h"
+
+class Action
+{
+public:
+    enum TriggeredBy { TriggeredByUser, TriggeredByRule, TriggeredByScript };
+
+    Action(const ActionTypeId &actionTypeId = ActionTypeId(), const ThingId &thingId = ThingId(), TriggeredBy triggeredBy = TriggeredByUser)
+        : m_actionTypeId{actionTypeId}
+        , m_thingId{thingId}
+        , m_triggeredBy{triggeredBy}
+    {}
+
+    ActionTypeId actionTypeId() const { return m_actionTypeId; }
+    ThingId thingId() const { return m_thingId; }
+    TriggeredBy triggeredBy() const { return m_triggeredBy; }
+
+    ParamList params() const { return m_params; }
+    void setParams(const ParamList &params) { m_params = params; }
+
+private:
+    ActionTypeId m_actionTypeId;
+    ThingId m_thingId;
+    TriggeredBy m_triggeredBy;
+    ParamList m_params;
+};
+
+#endif // MOCK_ACTION_H
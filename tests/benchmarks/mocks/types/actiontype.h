@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+
+#ifndef MOCK_ACTIONTYPE_H
+#define MOCK_ACTIONTYPE_H
+
+// Minimal stand-ins for the nymea action types used by the benchmarks
+
+#include "types/param.h"
+
+typedef QUuid ActionTypeId;
+
+class ActionType
+{
+public:
+    ActionType(const ActionTypeId &id = ActionTypeId(), const QString &name = QString(), const ParamTypes &paramTypes = ParamTypes())
+        : m_id{id}
+        , m_name{name}
+        , m_paramTypes{paramTypes}
+    {}
+
+    ActionTypeId id() const { return m_id; }
+    QString name() const { return m_name; }
+    ParamTypes paramTypes() const { return m_paramTypes; }
+
+private:
+    ActionTypeId m_id;
+    QString m_name;
+    ParamTypes m_paramTypes;
+};
+
+class ActionTypes : public QList<ActionType>
+{
+public:
+    ActionTypes() = default;
+    ActionTypes(const QList<ActionType> &other)
+        : QList<ActionType>(other)
+    {}
+
+    ActionType findById(const ActionTypeId &id) const
+    {
+        for (const ActionType &actionType : *this) {
+            if (actionType.id() == id)
+                return actionType;
+        }
+        return ActionType();
+    }
+
+    ActionType findByName(const QString &name) const
+    {
+        for (const ActionType &actionType : *this) {
+            if (actionType.name() == name)
+                return actionType;
+        }
+        return ActionType();
+    }
+};
+
+#endif // MOCK_ACTIONTYPE_H
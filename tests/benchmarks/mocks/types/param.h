@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+
+#ifndef MOCK_PARAM_H
+#define MOCK_PARAM_H
+
+// Minimal stand-ins for the nymea param types used by the benchmarks
+
+#include <QList>
+#include <QString>
+#include <QUuid>
+#include <QVariant>
+
+typedef QUuid ParamTypeId;
+
+class Param
+{
+public:
+    Param(const ParamTypeId &paramTypeId = ParamTypeId(), const QVariant &value = QVariant())
+        : m_paramTypeId{paramTypeId}
+        , m_value{value}
+    {}
+
+    ParamTypeId paramTypeId() const { return m_paramTypeId; }
+    QVariant value() const { return m_value; }
+
+private:
+    ParamTypeId m_paramTypeId;
+    QVariant m_value;
+};
+
+class ParamList : public QList<Param>
+{
+public:
+    ParamList() = default;
+};
+
+class ParamType
+{
+public:
+    ParamType(const ParamTypeId &id = ParamTypeId(), const QString &name = QString())
+        : m_id{id}
+        , m_name{name}
+    {}
+
+    ParamTypeId id() const { return m_id; }
+    QString name() const { return m_name; }
+
+private:
+    ParamTypeId m_id;
+    QString m_name;
+};
+
+class ParamTypes : public QList<ParamType>
+{
+public:
+    ParamTypes() = default;
+    ParamTypes(const QList<ParamType> &other)
+        : QList<ParamType>(other)
+    {}
+
+    ParamType findByName(const QString &name) const
+    {
+        for (const ParamType &paramType : *this) {
+            if (paramType.name() == name)
+                return paramType;
+        }
+        return ParamType();
+    }
+};
+
+#endif // MOCK_PARAM_H
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef MOCK_STATETYPE_H
+#define MOCK_STATETYPE_H
+
+// Minimal stand-ins for the nymea state types used by the benchmarks
+
+#include <QList>
+#include <QString>
+#include <QUuid>
+
+// A distinct type like in nymea, so it does not mix with state names
+class StateTypeId : public QUuid
+{
+public:
+    StateTypeId() = default;
+    explicit StateTypeId(const QUuid &other)
+        : QUuid(other)
+    {}
+
+    static StateTypeId createStateTypeId() { return StateTypeId(QUuid::createUuid()); }
+};
+
+class StateType
+{
+public:
+    StateType(const StateTypeId &id = StateTypeId(), const QString &name = QString())
+        : m_id{id}
+        , m_name{name}
+    {}
+
+    StateTypeId id() const { return m_id; }
+    QString name() const { return m_name; }
+
+private:
+    StateTypeId m_id;
+    QString m_name;
+};
+
+class StateTypes : public QList<StateType>
+{
+public:
+    StateTypes() = default;
+    StateTypes(const QList<StateType> &other)
+        : QList<StateType>(other)
+    {}
+
+    StateType findById(const StateTypeId &id) const
+    {
+        for (const StateType &stateType : *this) {
+            if (stateType.id() == id)
+                return stateType;
+        }
+        return StateType();
+    }
+
+    StateType findByName(const QString &name) const
+    {
+        for (const StateType &stateType : *this) {
+            if (stateType.name() == name)
+                return stateType;
+        }
+        return StateType();
+    }
+};
+
+#endif // MOCK_STATETYPE_H
@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef MOCK_WEBSERVERRESOURCE_H
+#define MOCK_WEBSERVERRESOURCE_H
+
+// Minimal stand-ins for the nymea web server types used by the benchmarks
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QJsonDocument>
+#include <QObject>
+#include <QUrl>
+#include <QUrlQuery>
+
+class HttpRequest
+{
+public:
+    enum RequestMethod { Get, Post, Put, Delete, Options, Unhandled };
+
+    HttpRequest(RequestMethod method = Get, const QUrl &url = QUrl(), const QByteArray &payload = QByteArray())
+        : m_method{method}
+        , m_url{url}
+        , m_payload{payload}
+    {}
+
+    RequestMethod method() const { return m_method; }
+    QUrl url() const { return m_url; }
+    QUrlQuery urlQuery() const { return QUrlQuery(m_url); }
+    QByteArray payload() const { return m_payload; }
+    QHash<QByteArray, QByteArray> rawHeaderList() const { return m_rawHeaders; }
+
+    void setRawHeader(const QByteArray &name, const QByteArray &value) { m_rawHeaders.insert(name, value); }
+
+private:
+    RequestMethod m_method;
+    QUrl m_url;
+    QByteArray m_payload;
+    QHash<QByteArray, QByteArray> m_rawHeaders;
+};
+
+class HttpReply : public QObject
+{
+    Q_OBJECT
+public:
+    enum HttpStatusCode {
+        Ok = 200,
+        Created = 201,
+        Accepted = 202,
+        NoContent = 204,
+        Found = 302,
+        NotModified = 304,
+        PermanentRedirect = 308,
+        BadRequest = 400,
+        Unauthorized = 401,
+        Forbidden = 403,
+        NotFound = 404,
+        MethodNotAllowed = 405,
+        RequestTimeout = 408,
+        Conflict = 409,
+        InternalServerError = 500,
+        NotImplemented = 501,
+        BadGateway = 502,
+        ServiceUnavailable = 503,
+        GatewayTimeout = 504,
+        HttpVersionNotSupported = 505
+    };
+    Q_ENUM(HttpStatusCode)
+
+    enum HttpHeaderType { ContentTypeHeader, ContentLengthHeader, ConnectionHeader, LocationHeader, UserAgentHeader, CacheControlHeader, AllowHeader, DateHeader, ServerHeader };
+    Q_ENUM(HttpHeaderType)
+
+    enum Type { TypeSync, TypeAsync };
+    Q_ENUM(Type)
+
+    explicit HttpReply(HttpStatusCode statusCode = Ok, Type type = TypeSync, QObject *parent = nullptr)
+        : QObject{parent}
+        , m_statusCode{statusCode}
+        , m_type{type}
+    {}
+
+    HttpStatusCode httpStatusCode() const { return m_statusCode; }
+    void setHttpStatusCode(HttpStatusCode statusCode) { m_statusCode = statusCode; }
+    Type type() const { return m_type; }
+
+    QByteArray payload() const { return m_payload; }
+    void setPayload(const QByteArray &payload) { m_payload = payload; }
+
+    void setHeader(HttpHeaderType headerType, const QByteArray &value) { m_headers.insert(headerType, value); }
+    QByteArray header(HttpHeaderType headerType) const { return m_headers.value(headerType); }
+
+    void setRawHeader(const QByteArray &name, const QByteArray &value) { m_rawHeaders.insert(name, value); }
+    QHash<QByteArray, QByteArray> rawHeaderList() const { return m_rawHeaders; }
+
+    static HttpReply *createJsonReply(const QJsonDocument &jsonDoc, HttpStatusCode statusCode = Ok)
+    {
+        HttpReply *reply = new HttpReply(statusCode);
+        reply->setHeader(ContentTypeHeader, "application/json; charset=\"utf-8\";");
+        reply->setPayload(jsonDoc.toJson(QJsonDocument::Compact));
+        return reply;
+    }
+
+    static HttpReply *createErrorReply(HttpStatusCode statusCode) { return new HttpReply(statusCode); }
+
+signals:
+    void finished();
+
+private:
+    HttpStatusCode m_statusCode;
+    Type m_type;
+    QByteArray m_payload;
+    QHash<int, QByteArray> m_headers;
+    QHash<QByteArray, QByteArray> m_rawHeaders;
+};
+
+class WebServerResource : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WebServerResource(const QString &basePath, QObject *parent = nullptr)
+        : QObject{parent}
+        , m_basePath{basePath}
+    {}
+
+    QString basePath() const { return m_basePath; }
+
+    bool enabled() const { return m_enabled; }
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+
+    virtual HttpReply *processRequest(const HttpRequest &request) = 0;
+
+    static HttpReply *createFileReply(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QFile::ReadOnly))
+            return HttpReply::createErrorReply(HttpReply::NotFound);
+
+        HttpReply *reply = new HttpReply(HttpReply::Ok);
+        reply->setPayload(file.readAll());
+        return reply;
+    }
+
+private:
+    QString m_basePath;
+    bool m_enabled = false;
+};
+
+#endif // MOCK_WEBSERVERRESOURCE_H
@@ -0,0 +1,23 @@
+TEMPLATE = app
+TARGET = tlshandshake
+
+include(../benchmarks.pri)
+
+CONFIG += link_pkgconfig
+PKGCONFIG += openssl
+
+QT += network websockets
+
+RESOURCES += tlshandshake.qrc
+
+HEADERS += $$top_srcdir/plugin/evdashframequeue.h \
+    $$top_srcdir/plugin/evdashtcpserver.h \
+    $$top_srcdir/plugin/evdashtlssessioncache.h \
+    $$top_srcdir/plugin/evdashwebsocketserver.h \
+    $$top_srcdir/plugin/evdashwebsocketworker.h
+
+SOURCES += tlshandshakebenchmark.cpp \
+    $$top_srcdir/plugin/evdashtcpserver.cpp \
+    $$top_srcdir/plugin/evdashtlssessioncache.cpp \
+    $$top_srcdir/plugin/evdashwebsocketserver.cpp \
+    $$top_srcdir/plugin/evdashwebsocketworker.cpp
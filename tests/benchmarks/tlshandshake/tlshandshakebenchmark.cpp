@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "evdashtlssessioncache.h"
+#include "evdashwebsocketserver.h"
+
+#include <QEventLoop>
+#include <QFile>
+#include <QSslCertificate>
+#include <QSslConfiguration>
+#include <QSslKey>
+#include <QSslSocket>
+#include <QTimer>
+#include <QWebSocket>
+#include <QtTest>
+
+Q_LOGGING_CATEGORY(dcEvDashExperience, "EvDashExperience")
+
+// Compares the cost of a full TLS handshake plus WebSocket upgrade against the
+// EV Dash server with a resumed one, with and without the shared session cache.
+class TlsHandshakeBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void handshake_data();
+    void handshake();
+
+private:
+    QSslConfiguration m_serverConfiguration;
+
+    QSslConfiguration clientConfiguration() const;
+    bool connectClient(quint16 port, const QSslConfiguration &configuration, QByteArray *sessionTicket = nullptr);
+};
+
+void TlsHandshakeBenchmark::initTestCase()
+{
+    if (!QSslSocket::supportsSsl())
+        QSKIP("No TLS support available");
+
+    QFile certificateFile(":/certificate.crt");
+    QVERIFY(certificateFile.open(QFile::ReadOnly));
+    QFile keyFile(":/certificate.key");
+    QVERIFY(keyFile.open(QFile::ReadOnly));
+
+    m_serverConfiguration = QSslConfiguration::defaultConfiguration();
+    m_serverConfiguration.setLocalCertificate(QSslCertificate(certificateFile.readAll(), QSsl::Pem));
+    m_serverConfiguration.setPrivateKey(QSslKey(keyFile.readAll(), QSsl::Rsa, QSsl::Pem));
+    m_serverConfiguration.setPeerVerifyMode(QSslSocket::VerifyNone);
+    m_serverConfiguration.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+    m_serverConfiguration.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+}
+
+void TlsHandshakeBenchmark::handshake_data()
+{
+    QTest::addColumn<bool>("resume");
+    QTest::addColumn<bool>("sessionCache");
+
+    QTest::newRow("full") << false << false;
+    QTest::newRow("resume-without-cache") << true << false;
+    QTest::newRow("resume-with-cache") << true << true;
+}
+
+void TlsHandshakeBenchmark::handshake()
+{
+    QFETCH(bool, resume);
+    QFETCH(bool, sessionCache);
+
+    if (sessionCache && !EvDashTlsSessionCache::isSupported())
+        QSKIP("TLS session cache not supported with the TLS backend in use");
+
+    EvDashWebSocketServer server;
+    server.setWorkerCount(2);
+    server.setConnectionLimits(1024, 1024);
+    QVERIFY(server.setSslConfiguration(m_serverConfiguration, sessionCache));
+    QVERIFY(server.listen(QHostAddress::LocalHost, 0));
+
+    // Warm up and fetch a session ticket to resume from
+    QByteArray sessionTicket;
+    QVERIFY(connectClient(server.serverPort(), clientConfiguration(), &sessionTicket));
+
+    QSslConfiguration configuration = clientConfiguration();
+    if (resume)
+        configuration.setSessionTicket(sessionTicket);
+
+    EvDashTlsSessionCache *cache = server.tlsSessionCache();
+    const quint64 resumedBefore = cache ? cache->resumedHandshakes() : 0;
+
+    QBENCHMARK {
+        QVERIFY(connectClient(server.serverPort(), configuration));
+    }
+
+    if (resume && cache)
+        QVERIFY(cache->resumedHandshakes() > resumedBefore);
+
+    server.close();
+}
+
+QSslConfiguration TlsHandshakeBenchmark::clientConfiguration() const
+{
+    // TLS 1.2 delivers the session ticket as part of the handshake
+    QSslConfiguration configuration = QSslConfiguration::defaultConfiguration();
+    configuration.setPeerVerifyMode(QSslSocket::VerifyNone);
+    configuration.setProtocol(QSsl::TlsV1_2);
+    configuration.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+    configuration.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+    return configuration;
+}
+
+bool TlsHandshakeBenchmark::connectClient(quint16 port, const QSslConfiguration &configuration, QByteArray *sessionTicket)
+{
+    // The server sockets live in worker threads, wait for the upgrade in an event loop
+    QWebSocket client;
+    client.setSslConfiguration(configuration);
+
+    QEventLoop loop;
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+    connect(&client, &QWebSocket::connected, &loop, &QEventLoop::quit);
+    connect(&client, &QWebSocket::disconnected, &loop, &QEventLoop::quit);
+    client.open(QUrl(QStringLiteral("wss://localhost:%1").arg(port)));
+    loop.exec();
+
+    if (client.state() != QAbstractSocket::ConnectedState)
+        return false;
+
+    if (sessionTicket)
+        *sessionTicket = client.sslConfiguration().sessionTicket();
+
+    client.close();
+    return true;
+}
+
+QTEST_GUILESS_MAIN(TlsHandshakeBenchmark)
+
+#include "tlshandshakebenchmark.moc"
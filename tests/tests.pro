@@ -0,0 +1,5 @@
+TEMPLATE = subdirs
+SUBDIRS += benchmarks
+
+benchmark.CONFIG = recursive
+QMAKE_EXTRA_TARGETS += benchmark
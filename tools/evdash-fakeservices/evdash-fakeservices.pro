@@ -0,0 +1,17 @@
+TEMPLATE = app
+TARGET = evdash-fakeservices
+
+include(../../config.pri)
+
+CONFIG += console
+CONFIG -= app_bundle
+
+QT -= gui
+QT += dbus
+
+HEADERS += fakechargingsessions.h \
+    fakeenergymanager.h
+
+SOURCES += main.cpp \
+    fakechargingsessions.cpp \
+    fakeenergymanager.cpp
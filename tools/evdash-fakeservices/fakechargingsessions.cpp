@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "fakechargingsessions.h"
+
+#include <QDateTime>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QTimer>
+#include <QUuid>
+
+FakeChargingSessions::FakeChargingSessions(int sessions, const QStringList &carIds, QObject *parent)
+    : QObject{parent}
+{
+    // One session every two hours going back from now, spread over the cars
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (int i = 0; i < sessions; i++) {
+        const qint64 startTimestamp = now - static_cast<qint64>(sessions - i) * 7200;
+
+        QVariantMap session;
+        session.insert("sessionId", i);
+        session.insert("carId", carIds.isEmpty() ? QUuid::createUuid().toString(QUuid::WithoutBraces) : carIds.at(i % carIds.count()));
+        session.insert("carName", QStringLiteral("Car %1").arg(carIds.isEmpty() ? i : i % carIds.count()));
+        session.insert("startTimestamp", startTimestamp);
+        session.insert("endTimestamp", startTimestamp + 3600);
+        session.insert("sessionEnergy", 5.0 + (i % 50));
+        session.insert("energyStart", 1000.0 + i * 12.5);
+        session.insert("energyEnd", 1012.5 + i * 12.5);
+        m_sessions.append(session);
+    }
+}
+
+void FakeChargingSessions::setLatency(int latency)
+{
+    m_latency = latency;
+}
+
+quint64 FakeChargingSessions::calls() const
+{
+    return m_calls;
+}
+
+QVariantList FakeChargingSessions::GetSessions(const QStringList &carThingIds, qlonglong startTimestamp, qlonglong endTimestamp)
+{
+    m_calls++;
+
+    QVariantList result;
+    for (const QVariant &sessionVariant : qAsConst(m_sessions)) {
+        const QVariantMap session = sessionVariant.toMap();
+        if (!carThingIds.isEmpty() && !carThingIds.contains(session.value("carId").toString()))
+            continue;
+
+        if (startTimestamp > 0 && session.value("endTimestamp").toLongLong() < startTimestamp)
+            continue;
+
+        if (endTimestamp > 0 && session.value("startTimestamp").toLongLong() > endTimestamp)
+            continue;
+
+        result.append(session);
+    }
+
+    if (m_latency <= 0)
+        return result;
+
+    setDelayedReply(true);
+    const QDBusMessage reply = message().createReply(QVariant::fromValue(result));
+    const QDBusConnection busConnection = connection();
+    QTimer::singleShot(m_latency, this, [busConnection, reply]() { busConnection.send(reply); });
+    return QVariantList();
+}
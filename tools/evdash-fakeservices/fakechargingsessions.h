@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef FAKECHARGINGSESSIONS_H
+#define FAKECHARGINGSESSIONS_H
+
+#include <QDBusContext>
+#include <QObject>
+#include <QStringList>
+#include <QVariantList>
+
+// Fake io.nymea.energy.chargingsessions service. Answers GetSessions from a
+// pre-generated session history after the configured latency.
+class FakeChargingSessions : public QObject, protected QDBusContext
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "io.nymea.energy.chargingsessions")
+public:
+    explicit FakeChargingSessions(int sessions, const QStringList &carIds, QObject *parent = nullptr);
+
+    void setLatency(int latency);
+
+    quint64 calls() const;
+
+public slots:
+    Q_SCRIPTABLE QVariantList GetSessions(const QStringList &carThingIds, qlonglong startTimestamp, qlonglong endTimestamp);
+
+private:
+    QVariantList m_sessions;
+    int m_latency = 0;
+    quint64 m_calls = 0;
+};
+
+#endif // FAKECHARGINGSESSIONS_H
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "fakeenergymanager.h"
+
+#include <QTimer>
+#include <QUuid>
+
+FakeEnergyManager::FakeEnergyManager(int chargers, const QStringList &chargerIds, QObject *parent)
+    : QObject{parent}
+{
+    for (int i = 0; i < chargers; i++) {
+        QVariantMap chargingInfo;
+        chargingInfo.insert("evChargerId", i < chargerIds.count() ? chargerIds.at(i) : QUuid::createUuid().toString(QUuid::WithoutBraces));
+        chargingInfo.insert("assignedCarId", QUuid::createUuid().toString(QUuid::WithoutBraces));
+        chargingInfo.insert("chargingMode", i % 3);
+        chargingInfo.insert("targetPercentage", 80);
+        chargingInfo.insert("spotMarketChargingEnabled", false);
+        chargingInfo.insert("dailySpotMarketPercentage", 0);
+        m_chargingInfos.append(chargingInfo);
+    }
+
+    // Tick often and emit whatever the rate allows since the last tick
+    m_stormTimer = new QTimer(this);
+    m_stormTimer->setInterval(10);
+    connect(m_stormTimer, &QTimer::timeout, this, &FakeEnergyManager::onStormTimeout);
+}
+
+void FakeEnergyManager::setStormRate(int signalsPerSecond)
+{
+    m_stormRate = signalsPerSecond;
+    m_stormBudget = 0;
+
+    if (m_stormRate <= 0 || m_chargingInfos.isEmpty()) {
+        m_stormTimer->stop();
+        return;
+    }
+
+    m_stormClock.start();
+    m_lastStormTick = 0;
+    m_stormTimer->start();
+}
+
+quint64 FakeEnergyManager::signalsEmitted() const
+{
+    return m_signalsEmitted;
+}
+
+QVariantList FakeEnergyManager::chargingInfos() const
+{
+    return m_chargingInfos;
+}
+
+void FakeEnergyManager::onStormTimeout()
+{
+    const qint64 now = m_stormClock.elapsed();
+    m_stormBudget += m_stormRate * (now - m_lastStormTick) / 1000.0;
+    m_lastStormTick = now;
+
+    while (m_stormBudget >= 1) {
+        m_stormBudget -= 1;
+
+        QVariantMap chargingInfo = m_chargingInfos.at(m_nextCharger).toMap();
+        chargingInfo.insert("chargingMode", (chargingInfo.value("chargingMode").toInt() + 1) % 3);
+        m_chargingInfos[m_nextCharger] = chargingInfo;
+        m_nextCharger = (m_nextCharger + 1) % m_chargingInfos.count();
+
+        m_signalsEmitted++;
+        emit chargingInfoChanged(chargingInfo);
+    }
+}
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef FAKEENERGYMANAGER_H
+#define FAKEENERGYMANAGER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+#include <QVariantList>
+#include <QVariantMap>
+
+class QTimer;
+
+// Fake io.nymea.energymanager service with a generated fleet of chargers.
+// Can flood the bus with chargingInfoChanged signals at a given rate.
+class FakeEnergyManager : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "io.nymea.energymanager")
+public:
+    explicit FakeEnergyManager(int chargers, const QStringList &chargerIds = QStringList(), QObject *parent = nullptr);
+
+    void setStormRate(int signalsPerSecond);
+
+    quint64 signalsEmitted() const;
+
+public slots:
+    Q_SCRIPTABLE QVariantList chargingInfos() const;
+
+signals:
+    Q_SCRIPTABLE void chargingInfoAdded(const QVariantMap &chargingInfo);
+    Q_SCRIPTABLE void chargingInfoRemoved(const QString &evChargerId);
+    Q_SCRIPTABLE void chargingInfoChanged(const QVariantMap &chargingInfo);
+
+private:
+    QVariantList m_chargingInfos;
+    QTimer *m_stormTimer = nullptr;
+    QElapsedTimer m_stormClock;
+    qint64 m_lastStormTick = 0;
+    double m_stormBudget = 0;
+    int m_stormRate = 0;
+    int m_nextCharger = 0;
+    quint64 m_signalsEmitted = 0;
+
+    void onStormTimeout();
+};
+
+#endif // FAKEENERGYMANAGER_H
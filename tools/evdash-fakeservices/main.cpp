@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "fakechargingsessions.h"
+#include "fakeenergymanager.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusError>
+#include <QTextStream>
+#include <QTimer>
+
+static const QString kEnergyManagerService = QStringLiteral("io.nymea.energymanager");
+static const QString kEnergyManagerPath = QStringLiteral("/io/nymea/energymanager");
+static const QString kChargingSessionsService = QStringLiteral("io.nymea.energy.chargingsessions");
+static const QString kChargingSessionsPath = QStringLiteral("/io/nymea/energy/chargingsessions");
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    application.setApplicationName("evdash-fakeservices");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Fake energy manager and charging sessions DBus services for testing the EV Dash plugin without the nymea energy stack. "
+                                     "Point the plugin to the same bus with the DBus/bus and DBus/address settings in evdash.conf. "
+                                     "A private bus can be started with \"dbus-daemon --session --print-address --fork\".");
+    parser.addHelpOption();
+
+    QCommandLineOption busOption("bus", "Bus to register on: system, session or address.", "bus", "session");
+    QCommandLineOption addressOption("address", "Bus address if --bus is address.", "address");
+    QCommandLineOption chargersOption("chargers", "Number of chargers in the energy manager fleet.", "count", "10");
+    QCommandLineOption chargerIdsOption("charger-ids", "Comma separated thing ids to use for the first chargers.", "ids");
+    QCommandLineOption stormOption("storm-rate", "chargingInfoChanged signals per second, 0 disables the storm.", "rate", "0");
+    QCommandLineOption sessionsOption("sessions", "Number of sessions in the charging session history.", "count", "1000");
+    QCommandLineOption latencyOption("latency", "GetSessions reply latency in milliseconds.", "ms", "0");
+    QCommandLineOption restartOption("restart-interval", "Unregister and register the services again every given seconds, 0 disables it.", "seconds", "0");
+    QCommandLineOption reportOption("report-interval", "Statistics report interval in seconds.", "seconds", "5");
+    parser.addOptions({busOption, addressOption, chargersOption, chargerIdsOption, stormOption, sessionsOption, latencyOption, restartOption, reportOption});
+    parser.process(application);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QDBusConnection connection(QStringLiteral("evdash-fakeservices"));
+    const QString bus = parser.value(busOption);
+    if (bus == QStringLiteral("system")) {
+        connection = QDBusConnection::systemBus();
+    } else if (bus == QStringLiteral("session")) {
+        connection = QDBusConnection::sessionBus();
+    } else if (bus == QStringLiteral("address")) {
+        connection = QDBusConnection::connectToBus(parser.value(addressOption), QStringLiteral("evdash-fakeservices"));
+    } else {
+        err << "Unknown bus " << bus << Qt::endl;
+        return 1;
+    }
+
+    if (!connection.isConnected()) {
+        err << "Could not connect to the " << bus << " bus: " << connection.lastError().message() << Qt::endl;
+        return 1;
+    }
+
+    const QStringList chargerIds = parser.value(chargerIdsOption).split(',', Qt::SkipEmptyParts);
+    FakeEnergyManager energyManager(qMax(0, parser.value(chargersOption).toInt()), chargerIds);
+
+    QStringList carIds;
+    for (const QVariant &chargingInfo : energyManager.chargingInfos())
+        carIds.append(chargingInfo.toMap().value("assignedCarId").toString());
+
+    FakeChargingSessions chargingSessions(qMax(0, parser.value(sessionsOption).toInt()), carIds);
+    chargingSessions.setLatency(qMax(0, parser.value(latencyOption).toInt()));
+
+    if (!connection.registerObject(kEnergyManagerPath, &energyManager, QDBusConnection::ExportScriptableContents)
+        || !connection.registerObject(kChargingSessionsPath, &chargingSessions, QDBusConnection::ExportScriptableContents)) {
+        err << "Could not register the DBus objects: " << connection.lastError().message() << Qt::endl;
+        return 1;
+    }
+
+    auto registerServices = [&connection, &err]() {
+        const bool registered = connection.registerService(kEnergyManagerService) && connection.registerService(kChargingSessionsService);
+        if (!registered)
+            err << "Could not register the DBus services: " << connection.lastError().message() << Qt::endl;
+
+        return registered;
+    };
+
+    if (!registerServices())
+        return 1;
+
+    out << "Serving " << energyManager.chargingInfos().count() << " chargers and " << parser.value(sessionsOption) << " sessions on the " << bus << " bus" << Qt::endl;
+
+    energyManager.setStormRate(qMax(0, parser.value(stormOption).toInt()));
+
+    // Exercise the reconnect handling of the clients
+    QTimer restartTimer;
+    const int restartInterval = qMax(0, parser.value(restartOption).toInt());
+    if (restartInterval > 0) {
+        restartTimer.setInterval(restartInterval * 1000);
+        QObject::connect(&restartTimer, &QTimer::timeout, &application, [&connection, &out, registerServices]() {
+            out << "Restarting services" << Qt::endl;
+            connection.unregisterService(kEnergyManagerService);
+            connection.unregisterService(kChargingSessionsService);
+            QTimer::singleShot(1000, [registerServices]() { registerServices(); });
+        });
+        restartTimer.start();
+    }
+
+    QTimer reportTimer;
+    reportTimer.setInterval(qMax(1, parser.value(reportOption).toInt()) * 1000);
+    QObject::connect(&reportTimer, &QTimer::timeout, &application, [&out, &energyManager, &chargingSessions]() {
+        out << "chargingInfoChanged signals: " << energyManager.signalsEmitted() << ", GetSessions calls: " << chargingSessions.calls() << Qt::endl;
+    });
+    reportTimer.start();
+
+    return application.exec();
+}
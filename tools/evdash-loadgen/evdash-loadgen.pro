@@ -0,0 +1,17 @@
+TEMPLATE = app
+TARGET = evdash-loadgen
+
+include(../../config.pri)
+
+CONFIG += console
+CONFIG -= app_bundle
+
+QT -= gui
+QT += network websockets
+
+HEADERS += loadclient.h \
+    loadgenerator.h
+
+SOURCES += main.cpp \
+    loadclient.cpp \
+    loadgenerator.cpp
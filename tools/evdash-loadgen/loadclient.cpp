@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "loadclient.h"
+
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QWebSocket>
+
+LoadClient::LoadClient(int index, const QUrl &url, const QString &token, QObject *parent)
+    : QObject{parent}
+    , m_index{index}
+    , m_url{url}
+    , m_token{token}
+{
+    m_clock.start();
+
+    m_webSocket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+    connect(m_webSocket, &QWebSocket::connected, this, &LoadClient::onConnected);
+    connect(m_webSocket, &QWebSocket::disconnected, this, &LoadClient::onDisconnected);
+    connect(m_webSocket, &QWebSocket::textMessageReceived, this, &LoadClient::onTextMessageReceived);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    connect(m_webSocket, &QWebSocket::errorOccurred, this, &LoadClient::onError);
+#else
+    connect(m_webSocket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error), this, &LoadClient::onError);
+#endif
+
+    // Load tests run against localhost, self signed certificates are expected
+    connect(m_webSocket, &QWebSocket::sslErrors, m_webSocket, [this](const QList<QSslError> &) { m_webSocket->ignoreSslErrors(); });
+
+    m_actionTimer = new QTimer(this);
+    m_actionTimer->setInterval(1000);
+    connect(m_actionTimer, &QTimer::timeout, this, &LoadClient::onActionTimeout);
+}
+
+void LoadClient::setActionMix(const QList<QPair<QString, int>> &actionMix)
+{
+    m_actionMix = actionMix;
+    m_actionWeightSum = 0;
+    for (const QPair<QString, int> &action : actionMix)
+        m_actionWeightSum += action.second;
+}
+
+void LoadClient::setInterval(int interval)
+{
+    m_actionTimer->setInterval(interval);
+}
+
+void LoadClient::start()
+{
+    m_webSocket->open(m_url);
+}
+
+void LoadClient::stop()
+{
+    m_stopping = true;
+    m_actionTimer->stop();
+    m_webSocket->close();
+}
+
+int LoadClient::pendingRequests() const
+{
+    return m_pendingRequests.count();
+}
+
+void LoadClient::onConnected()
+{
+    m_connected = true;
+    sendRequest(QStringLiteral("authenticate"), QJsonObject{{QStringLiteral("token"), m_token}});
+}
+
+void LoadClient::onDisconnected()
+{
+    m_actionTimer->stop();
+
+    if (m_stopping || !m_connected)
+        return;
+
+    m_connected = false;
+    emit connectionClosed(m_authenticated, m_webSocket->closeCode(), m_webSocket->closeReason());
+}
+
+void LoadClient::onError()
+{
+    // Errors of established connections show up as a close
+    if (m_stopping || m_connected)
+        return;
+
+    m_stopping = true;
+    emit connectionFailed(m_webSocket->errorString());
+}
+
+void LoadClient::onTextMessageReceived(const QString &message)
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    const QJsonObject messageObject = QJsonDocument::fromJson(message.toUtf8()).object();
+
+    // Notifications carry the event name and the time they have been sent
+    const QString event = messageObject.value(QStringLiteral("event")).toString();
+    if (!event.isEmpty()) {
+        const qint64 timestamp = static_cast<qint64>(messageObject.value(QStringLiteral("timestamp")).toDouble());
+        emit notificationReceived(event, timestamp > 0 ? QDateTime::currentMSecsSinceEpoch() - timestamp : -1);
+        return;
+    }
+
+    const QString requestId = messageObject.value(QStringLiteral("requestId")).toString();
+    if (!m_pendingRequests.contains(requestId))
+        return;
+
+    const PendingRequest request = m_pendingRequests.take(requestId);
+    const bool success = messageObject.value(QStringLiteral("success")).toBool();
+    emit requestFinished(request.action, now - request.sent, success);
+
+    if (request.action == QStringLiteral("authenticate") && success && !m_authenticated) {
+        m_authenticated = true;
+        emit authenticated();
+
+        // Spread the clients over the interval
+        QTimer::singleShot(QRandomGenerator::global()->bounded(qMax(1, m_actionTimer->interval())), m_actionTimer, QOverload<>::of(&QTimer::start));
+    }
+}
+
+void LoadClient::onActionTimeout()
+{
+    if (m_actionWeightSum <= 0)
+        return;
+
+    int pick = QRandomGenerator::global()->bounded(m_actionWeightSum);
+    for (const QPair<QString, int> &action : qAsConst(m_actionMix)) {
+        pick -= action.second;
+        if (pick >= 0)
+            continue;
+
+        if (action.first == QStringLiteral("idle"))
+            return;
+
+        sendRequest(action.first);
+        return;
+    }
+}
+
+void LoadClient::sendRequest(const QString &action, const QJsonObject &payload)
+{
+    const QString requestId = QStringLiteral("%1-%2").arg(m_index).arg(++m_requestCounter);
+
+    QJsonObject request;
+    request.insert(QStringLiteral("requestId"), requestId);
+    request.insert(QStringLiteral("action"), action);
+    if (!payload.isEmpty())
+        request.insert(QStringLiteral("payload"), payload);
+
+    PendingRequest pendingRequest;
+    pendingRequest.action = action;
+    pendingRequest.sent = m_clock.nsecsElapsed();
+    m_pendingRequests.insert(requestId, pendingRequest);
+
+    m_webSocket->sendTextMessage(QString::fromUtf8(QJsonDocument(request).toJson(QJsonDocument::Compact)));
+}
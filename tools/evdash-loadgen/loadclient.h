@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef LOADCLIENT_H
+#define LOADCLIENT_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QUrl>
+#include <QWebSocketProtocol>
+
+class QTimer;
+class QWebSocket;
+
+// One simulated dashboard. Authenticates with the given token and then picks
+// a weighted random action every interval, "idle" only listens.
+class LoadClient : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LoadClient(int index, const QUrl &url, const QString &token, QObject *parent = nullptr);
+
+    void setActionMix(const QList<QPair<QString, int>> &actionMix);
+    void setInterval(int interval);
+
+    void start();
+    void stop();
+
+    int pendingRequests() const;
+
+signals:
+    void authenticated();
+    void requestFinished(const QString &action, qint64 latencyNanoseconds, bool success);
+    void notificationReceived(const QString &event, qint64 lagMilliseconds);
+    void connectionFailed(const QString &errorString);
+    void connectionClosed(bool authenticated, QWebSocketProtocol::CloseCode closeCode, const QString &reason);
+
+private:
+    struct PendingRequest
+    {
+        QString action;
+        qint64 sent = 0;
+    };
+
+    int m_index = 0;
+    QUrl m_url;
+    QString m_token;
+    QWebSocket *m_webSocket = nullptr;
+    QTimer *m_actionTimer = nullptr;
+    QElapsedTimer m_clock;
+    QList<QPair<QString, int>> m_actionMix;
+    int m_actionWeightSum = 0;
+    bool m_connected = false;
+    bool m_authenticated = false;
+    bool m_stopping = false;
+    quint64 m_requestCounter = 0;
+    QHash<QString, PendingRequest> m_pendingRequests;
+
+    void onConnected();
+    void onDisconnected();
+    void onError();
+    void onTextMessageReceived(const QString &message);
+    void onActionTimeout();
+
+    void sendRequest(const QString &action, const QJsonObject &payload = QJsonObject());
+};
+
+#endif // LOADCLIENT_H
@@ -0,0 +1,278 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "loadgenerator.h"
+#include "loadclient.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTextStream>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+
+static QString formatMilliseconds(qint64 nanoseconds)
+{
+    return QString::number(nanoseconds / 1e6, 'f', 2);
+}
+
+LoadGenerator::LoadGenerator(const LoadGeneratorConfiguration &configuration, QObject *parent)
+    : QObject{parent}
+    , m_configuration{configuration}
+{
+    m_networkManager = new QNetworkAccessManager(this);
+    connect(m_networkManager, &QNetworkAccessManager::finished, this, &LoadGenerator::onLoginFinished);
+
+    m_rampUpTimer = new QTimer(this);
+    m_rampUpTimer->setInterval(m_configuration.rampUp);
+    connect(m_rampUpTimer, &QTimer::timeout, this, &LoadGenerator::openNextClient);
+
+    m_reportTimer = new QTimer(this);
+    m_reportTimer->setInterval(m_configuration.reportInterval * 1000);
+    connect(m_reportTimer, &QTimer::timeout, this, &LoadGenerator::printProgress);
+}
+
+void LoadGenerator::start()
+{
+    QUrl url;
+    url.setScheme(m_configuration.tls ? QStringLiteral("https") : QStringLiteral("http"));
+    url.setHost(m_configuration.host);
+    url.setPort(m_configuration.webPort);
+    url.setPath(QStringLiteral("/evdash/api/login"));
+
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
+
+    QJsonObject credentials{{QStringLiteral("username"), m_configuration.username}, {QStringLiteral("password"), m_configuration.password}};
+    QNetworkReply *reply = m_networkManager->post(request, QJsonDocument(credentials).toJson(QJsonDocument::Compact));
+    connect(reply, &QNetworkReply::sslErrors, reply, [reply](const QList<QSslError> &) { reply->ignoreSslErrors(); });
+}
+
+void LoadGenerator::onLoginFinished(QNetworkReply *reply)
+{
+    reply->deleteLater();
+
+    const QJsonObject response = QJsonDocument::fromJson(reply->readAll()).object();
+    m_token = response.value(QStringLiteral("token")).toString();
+    if (m_token.isEmpty()) {
+        QTextStream(stderr) << "Login failed: " << (reply->error() != QNetworkReply::NoError ? reply->errorString() : response.value(QStringLiteral("error")).toString()) << Qt::endl;
+        emit finished(1);
+        return;
+    }
+
+    QTextStream(stdout) << "Logged in as " << m_configuration.username << ", opening " << m_configuration.clients << " clients" << Qt::endl;
+
+    m_runTimer.start();
+    m_rampUpTimer->start();
+    m_reportTimer->start();
+    QTimer::singleShot(m_configuration.duration * 1000, this, &LoadGenerator::stop);
+}
+
+void LoadGenerator::openNextClient()
+{
+    if (m_clients.count() >= m_configuration.clients) {
+        m_rampUpTimer->stop();
+        return;
+    }
+
+    QUrl url;
+    url.setScheme(m_configuration.tls ? QStringLiteral("wss") : QStringLiteral("ws"));
+    url.setHost(m_configuration.host);
+    url.setPort(m_configuration.webSocketPort);
+
+    LoadClient *client = new LoadClient(m_clients.count(), url, m_token, this);
+    client->setActionMix(m_configuration.actionMix);
+    client->setInterval(m_configuration.interval);
+
+    connect(client, &LoadClient::authenticated, this, [this]() { m_authenticatedClients++; });
+    connect(client, &LoadClient::requestFinished, this, [this](const QString &action, qint64 latencyNanoseconds, bool success) {
+        ActionStatistics &statistics = m_actionStatistics[action];
+        statistics.latencies.append(latencyNanoseconds);
+        if (!success)
+            statistics.errors++;
+    });
+    connect(client, &LoadClient::notificationReceived, this, [this](const QString &event, qint64 lagMilliseconds) {
+        m_notificationCounts[event]++;
+        if (lagMilliseconds >= 0)
+            m_notificationLags.append(lagMilliseconds * 1000000);
+    });
+    connect(client, &LoadClient::connectionFailed, this, [this](const QString &errorString) {
+        if (m_failedConnections == 0)
+            QTextStream(stderr) << "Connection failed: " << errorString << Qt::endl;
+
+        m_failedConnections++;
+    });
+    connect(client, &LoadClient::connectionClosed, this, [this](bool authenticated, QWebSocketProtocol::CloseCode closeCode, const QString &reason) {
+        Q_UNUSED(reason)
+        m_closedConnections++;
+        if (!authenticated)
+            m_closedBeforeAuthentication++;
+
+        m_closeCodes[closeCode]++;
+    });
+
+    m_clients.append(client);
+    client->start();
+}
+
+void LoadGenerator::printProgress()
+{
+    int requests = 0;
+    for (const ActionStatistics &statistics : qAsConst(m_actionStatistics))
+        requests += statistics.latencies.count();
+
+    QTextStream(stdout) << QString("[%1 s] clients %2/%3 authenticated, %4 failed, %5 closed, %6 replies, %7 notifications")
+                               .arg(m_runTimer.elapsed() / 1000)
+                               .arg(m_authenticatedClients)
+                               .arg(m_configuration.clients)
+                               .arg(m_failedConnections)
+                               .arg(m_closedConnections)
+                               .arg(requests)
+                               .arg(m_notificationLags.count())
+                        << Qt::endl;
+}
+
+void LoadGenerator::stop()
+{
+    m_rampUpTimer->stop();
+    m_reportTimer->stop();
+
+    // Requests still waiting for a reply count as lost
+    for (LoadClient *client : qAsConst(m_clients)) {
+        const int pending = client->pendingRequests();
+        if (pending > 0)
+            m_actionStatistics[QStringLiteral("unanswered")].errors += pending;
+
+        client->stop();
+    }
+
+    if (m_configuration.json) {
+        printJsonSummary();
+    } else {
+        printSummary();
+    }
+
+    // Give the close frames a moment to go out
+    const int exitCode = m_authenticatedClients > 0 ? 0 : 1;
+    QTimer::singleShot(500, this, [this, exitCode]() { emit finished(exitCode); });
+}
+
+void LoadGenerator::printSummary() const
+{
+    QTextStream out(stdout);
+    out << Qt::endl;
+    out << "Connections: " << m_clients.count() << " opened, " << m_authenticatedClients << " authenticated, " << m_failedConnections << " failed, "
+        << m_closedConnections << " closed by the server (" << m_closedBeforeAuthentication << " before authentication)" << Qt::endl;
+
+    for (auto it = m_closeCodes.constBegin(); it != m_closeCodes.constEnd(); ++it)
+        out << "  close code " << it.key() << ": " << it.value() << Qt::endl;
+
+    out << Qt::endl;
+    out << QString("%1 %2 %3 %4 %5 %6 %7").arg("Request latency [ms]", -24).arg("count", 8).arg("errors", 8).arg("p50", 9).arg("p90", 9).arg("p99", 9).arg("max", 9) << Qt::endl;
+    for (auto it = m_actionStatistics.constBegin(); it != m_actionStatistics.constEnd(); ++it) {
+        const QVector<qint64> &latencies = it.value().latencies;
+        out << QString("%1 %2 %3 %4 %5 %6 %7")
+                   .arg(it.key(), -24)
+                   .arg(latencies.count(), 8)
+                   .arg(it.value().errors, 8)
+                   .arg(formatMilliseconds(percentile(latencies, 0.5)), 9)
+                   .arg(formatMilliseconds(percentile(latencies, 0.9)), 9)
+                   .arg(formatMilliseconds(percentile(latencies, 0.99)), 9)
+                   .arg(formatMilliseconds(percentile(latencies, 1)), 9)
+            << Qt::endl;
+    }
+
+    out << Qt::endl;
+    out << "Notifications: " << m_notificationLags.count() << " received, lag p50 " << formatMilliseconds(percentile(m_notificationLags, 0.5)) << " ms, p90 "
+        << formatMilliseconds(percentile(m_notificationLags, 0.9)) << " ms, p99 " << formatMilliseconds(percentile(m_notificationLags, 0.99)) << " ms, max "
+        << formatMilliseconds(percentile(m_notificationLags, 1)) << " ms" << Qt::endl;
+
+    for (auto it = m_notificationCounts.constBegin(); it != m_notificationCounts.constEnd(); ++it)
+        out << "  " << it.key() << ": " << it.value() << Qt::endl;
+}
+
+void LoadGenerator::printJsonSummary() const
+{
+    QJsonObject closeCodes;
+    for (auto it = m_closeCodes.constBegin(); it != m_closeCodes.constEnd(); ++it)
+        closeCodes.insert(QString::number(it.key()), it.value());
+
+    QJsonObject connections;
+    connections.insert("opened", m_clients.count());
+    connections.insert("authenticated", m_authenticatedClients);
+    connections.insert("failed", m_failedConnections);
+    connections.insert("closed", m_closedConnections);
+    connections.insert("closedBeforeAuthentication", m_closedBeforeAuthentication);
+    connections.insert("closeCodes", closeCodes);
+
+    QJsonObject requests;
+    for (auto it = m_actionStatistics.constBegin(); it != m_actionStatistics.constEnd(); ++it) {
+        const QVector<qint64> &latencies = it.value().latencies;
+        QJsonObject action;
+        action.insert("count", latencies.count());
+        action.insert("errors", it.value().errors);
+        action.insert("p50", percentile(latencies, 0.5) / 1e6);
+        action.insert("p90", percentile(latencies, 0.9) / 1e6);
+        action.insert("p99", percentile(latencies, 0.99) / 1e6);
+        action.insert("max", percentile(latencies, 1) / 1e6);
+        requests.insert(it.key(), action);
+    }
+
+    QJsonObject events;
+    for (auto it = m_notificationCounts.constBegin(); it != m_notificationCounts.constEnd(); ++it)
+        events.insert(it.key(), it.value());
+
+    QJsonObject notifications;
+    notifications.insert("count", m_notificationLags.count());
+    notifications.insert("lagP50", percentile(m_notificationLags, 0.5) / 1e6);
+    notifications.insert("lagP90", percentile(m_notificationLags, 0.9) / 1e6);
+    notifications.insert("lagP99", percentile(m_notificationLags, 0.99) / 1e6);
+    notifications.insert("lagMax", percentile(m_notificationLags, 1) / 1e6);
+    notifications.insert("events", events);
+
+    QJsonObject summary;
+    summary.insert("clients", m_configuration.clients);
+    summary.insert("duration", m_configuration.duration);
+    summary.insert("connections", connections);
+    summary.insert("requests", requests);
+    summary.insert("notifications", notifications);
+
+    QTextStream(stdout) << QJsonDocument(summary).toJson(QJsonDocument::Indented);
+}
+
+qint64 LoadGenerator::percentile(QVector<qint64> values, double fraction)
+{
+    if (values.isEmpty())
+        return 0;
+
+    std::sort(values.begin(), values.end());
+    const int index = qBound(0, static_cast<int>(std::ceil(fraction * values.count())) - 1, values.count() - 1);
+    return values.at(index);
+}
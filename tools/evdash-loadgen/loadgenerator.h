@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QPair>
+#include <QVector>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+class LoadClient;
+
+struct LoadGeneratorConfiguration
+{
+    QString host = QStringLiteral("127.0.0.1");
+    quint16 webPort = 80;
+    quint16 webSocketPort = 4449;
+    bool tls = false;
+    QString username;
+    QString password;
+    int clients = 10;
+    int duration = 60;
+    int interval = 1000;
+    int rampUp = 10;
+    int reportInterval = 5;
+    QList<QPair<QString, int>> actionMix;
+    bool json = false;
+};
+
+// Logs in once, opens the configured number of dashboard clients and
+// collects latency and connection statistics until the duration is over.
+class LoadGenerator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LoadGenerator(const LoadGeneratorConfiguration &configuration, QObject *parent = nullptr);
+
+    void start();
+
+signals:
+    void finished(int exitCode);
+
+private:
+    struct ActionStatistics
+    {
+        QVector<qint64> latencies;
+        int errors = 0;
+    };
+
+    LoadGeneratorConfiguration m_configuration;
+    QNetworkAccessManager *m_networkManager = nullptr;
+    QTimer *m_rampUpTimer = nullptr;
+    QTimer *m_reportTimer = nullptr;
+    QElapsedTimer m_runTimer;
+    QString m_token;
+    QList<LoadClient *> m_clients;
+
+    int m_connectedClients = 0;
+    int m_authenticatedClients = 0;
+    int m_failedConnections = 0;
+    int m_closedConnections = 0;
+    int m_closedBeforeAuthentication = 0;
+    QMap<int, int> m_closeCodes;
+
+    QMap<QString, ActionStatistics> m_actionStatistics;
+    QMap<QString, int> m_notificationCounts;
+    QVector<qint64> m_notificationLags;
+
+    void onLoginFinished(QNetworkReply *reply);
+    void openNextClient();
+    void printProgress();
+    void stop();
+
+    void printSummary() const;
+    void printJsonSummary() const;
+
+    static qint64 percentile(QVector<qint64> values, double fraction);
+};
+
+#endif // LOADGENERATOR_H
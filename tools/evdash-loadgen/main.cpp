@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright (C) 2013 - 2024, nymea GmbH
+* Copyright (C) 2024 - 2025, chargebyte austria GmbH
+*
+* This file is part of nymea-experience-plugin-evdash.
+*
+* nymea-experience-plugin-evdash is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* nymea-experience-plugin-evdash is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with nymea-experience-plugin-evdash. If not, see <https://www.gnu.org/licenses/>.
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "loadgenerator.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QTextStream>
+
+static bool parseActionMix(const QString &value, QList<QPair<QString, int>> *actionMix)
+{
+    static const QStringList knownActions = {QStringLiteral("GetChargers"), QStringLiteral("GetChargingSessions"), QStringLiteral("GetCars"), QStringLiteral("ping"), QStringLiteral("idle")};
+
+    for (const QString &entry : value.split(',', Qt::SkipEmptyParts)) {
+        const QStringList parts = entry.split('=');
+        bool ok = false;
+        const int weight = parts.count() == 2 ? parts.at(1).toInt(&ok) : 0;
+        if (!ok || weight < 0 || !knownActions.contains(parts.at(0)))
+            return false;
+
+        actionMix->append(qMakePair(parts.at(0), weight));
+    }
+
+    return !actionMix->isEmpty();
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    application.setApplicationName("evdash-loadgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Load generator for the EV Dash WebSocket API. Logs in on the local nymead web server, "
+                                     "opens the given number of dashboard clients and reports latencies and dropped connections.");
+    parser.addHelpOption();
+
+    QCommandLineOption hostOption("host", "Address of the local nymead instance.", "address", "127.0.0.1");
+    QCommandLineOption webPortOption("web-port", "Port of the nymead web server used for the login.", "port", "80");
+    QCommandLineOption webSocketPortOption("port", "Port of the EV Dash WebSocket server.", "port", "4449");
+    QCommandLineOption tlsOption("tls", "Use https and wss. Certificate errors are ignored.");
+    QCommandLineOption usernameOption({"u", "username"}, "Dashboard user name.", "username");
+    QCommandLineOption passwordOption({"p", "password"}, "Dashboard password.", "password");
+    QCommandLineOption clientsOption({"c", "clients"}, "Number of concurrent clients.", "count", "10");
+    QCommandLineOption durationOption({"d", "duration"}, "Test duration in seconds.", "seconds", "60");
+    QCommandLineOption intervalOption({"i", "interval"}, "Interval between two actions of one client in milliseconds.", "ms", "1000");
+    QCommandLineOption rampUpOption("ramp-up", "Delay between opening two clients in milliseconds.", "ms", "10");
+    QCommandLineOption mixOption("mix", "Weighted action mix, e.g. GetChargers=2,GetChargingSessions=1,idle=7.", "mix", "GetChargers=2,GetChargingSessions=1,idle=7");
+    QCommandLineOption reportOption("report-interval", "Progress report interval in seconds.", "seconds", "5");
+    QCommandLineOption jsonOption("json", "Print the summary as JSON.");
+    parser.addOptions({hostOption, webPortOption, webSocketPortOption, tlsOption, usernameOption, passwordOption, clientsOption, durationOption, intervalOption, rampUpOption, mixOption, reportOption, jsonOption});
+    parser.process(application);
+
+    QTextStream err(stderr);
+
+    LoadGeneratorConfiguration configuration;
+    configuration.host = parser.value(hostOption);
+    configuration.webPort = parser.value(webPortOption).toUShort();
+    configuration.webSocketPort = parser.value(webSocketPortOption).toUShort();
+    configuration.tls = parser.isSet(tlsOption);
+    configuration.username = parser.value(usernameOption);
+    configuration.password = parser.value(passwordOption);
+    configuration.clients = qMax(1, parser.value(clientsOption).toInt());
+    configuration.duration = qMax(1, parser.value(durationOption).toInt());
+    configuration.interval = qMax(1, parser.value(intervalOption).toInt());
+    configuration.rampUp = qMax(0, parser.value(rampUpOption).toInt());
+    configuration.reportInterval = qMax(1, parser.value(reportOption).toInt());
+    configuration.json = parser.isSet(jsonOption);
+
+    // Never point this at someone else's system
+    if (configuration.host != QStringLiteral("localhost") && !QHostAddress(configuration.host).isLoopback()) {
+        err << "Only loopback addresses are allowed: " << configuration.host << Qt::endl;
+        return 1;
+    }
+
+    if (configuration.username.isEmpty() || configuration.password.isEmpty()) {
+        err << "Username and password are required." << Qt::endl;
+        return 1;
+    }
+
+    if (!parseActionMix(parser.value(mixOption), &configuration.actionMix)) {
+        err << "Invalid action mix: " << parser.value(mixOption) << Qt::endl;
+        return 1;
+    }
+
+    LoadGenerator generator(configuration);
+    QObject::connect(&generator, &LoadGenerator::finished, &application, &QCoreApplication::exit);
+    generator.start();
+
+    return application.exec();
+}